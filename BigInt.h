@@ -1,807 +1,4874 @@
 #ifndef __BIGINT_H__
 #define __BIGINT_H__
 
-#include <vector> // the BigInt number is stored as a vector
+#include <vector> // for scratch space in the kernels
 #include <string> // strings are used to convert other data types to BigInt
-
-#include <algorithm> // for std::reverse, in several arithmetic operators
+#include <cstdint> // for the fixed-width 64-bit limbs
+#include <cstddef> // for size_t
+#include <cstring> // for std::memcpy, moving limbs to and from byte buffers
+#include <stdexcept> // for errors on malformed input
+#include <utility> // for std::pair, returned by divmod
+#include <tuple> // for std::tuple, returned by xgcd
+#include <random> // for the random bases in Miller-Rabin
+#include <array> // for the limbs of compile-time constants
+
+#include <algorithm> // for std::max and std::reverse
+#include <iterator> // for std::distance, sizing a LimbVector from an iterator range
+#include <type_traits> // for telling iterators apart from counts in LimbVector
+#include <new> // for ::operator new, the heap blocks of large LimbVectors
+#include <memory_resource> // for std::pmr::memory_resource, the pluggable source of limb storage
+#include <thread> // for the worker threads of parallel multiplication
+#include <mutex> // for the work-stealing queues
+#include <condition_variable> // for idle workers waiting for tasks
+#include <deque> // for the work-stealing queues
+#include <atomic> // for counting outstanding tasks
+#include <functional> // for std::function, the tasks forked onto the pool
+#include <memory> // for std::unique_ptr, owning the pool and its queues
+#include <optional> // for a per-thread override of the execution policy
+#include <exception> // for std::exception_ptr, carrying a task's exception back to its caller
 #include <iostream> // for >> and << operators
 
 
-class BigInt {
-public:
-    std::vector<int> number;  // holds all the digits (ex: {1, 3, 5})
-    void initialize(std::string);  // Generates this BigInt's number vector from an std::string input
-
-    unsigned int size() const;  // returns the size (number of digits) of the BigInt
-    bool negative = false;  // By default, the BigInt is not set to be negative
-
-    BigInt();  // ex: BigInt a()
-    BigInt(const BigInt&);
-    BigInt(int);  // ex: BigInt a(135)
-    BigInt(std::string);  // ex: BigInt a(string("135"))
-    BigInt(const char*);  // ex: BigInt a("135")
-
-    BigInt& operator=(const BigInt);  // ex: BigInt a = someBigInt
-    BigInt& operator=(const char*);  // ex: BigInt a = "135"
-    BigInt& operator=(const int&);  // ex: BigInt a = 135
-    BigInt& operator=(std::string);  // ex: BigInt a = std::string("135")
-    BigInt& operator=(std::vector<int>);  // ex: BigInt a = std::vector({1, 3, 5})
-
-    BigInt& operator+=(const BigInt&);  // ex: a += 5
-    BigInt& operator-=(const BigInt&);  // ex: a -= 5
-    BigInt& operator*=(const BigInt&);  // ex: a *= 5
-    BigInt& operator/=(const BigInt&);  // ex: a /= 5
-    BigInt& operator%=(const BigInt&);  // ex: a %= 5
+// ////////// Limb Memory ////////// //
 
-    BigInt& operator++(int);  // postfix increment
-    BigInt& operator++();  // prefix increment
+// where limb buffers come from: the heap blocks of BigInts are drawn from a std::pmr::memory_resource (by
+// default LimbPool, which keeps freed blocks of common sizes in a per-thread cache), and the kernels take
+// their temporaries from a per-thread ScratchArena that is released a whole scope at a time
+namespace bigint_detail {
 
-    BigInt& operator--(int);  // postfix decrement
-    BigInt& operator--();  // prefix decrement
+typedef uint64_t limb;  // one base 2^64 "digit" of a number
 
-    friend std::ostream& operator<<(std::ostream&, const BigInt&);  // output the BigInt onto an stream (ex: someOutputStream << someBigInt)
-    friend std::istream& operator>>(std::istream&, const BigInt&);  // read form a stream into a BigInt (ex: someInputStream >> someBigInt)
+// a size-class pool: requests are rounded up to 2^k limbs, and freed blocks of up to 2^max_class limbs go
+// onto the freeing thread's free list for that class instead of back to the system allocator. Every block
+// is a plain ::operator new block, so any thread may free or reuse any other thread's blocks, and worker
+// threads never contend on a shared lock in the steady state
+class LimbPool final : public std::pmr::memory_resource {
+public:
+    static const unsigned int min_class = 3;  // 8 limbs (64 bytes)
+    static const unsigned int max_class = 16;  // 65536 limbs (512 KiB); larger blocks bypass the pool
+    static const size_t cache_bytes = 1 << 20;  // each thread keeps at most about this much per class
+
+    static LimbPool* instance();  // the process-wide pool (its free lists are per thread)
+    static size_t block_limbs(size_t limbs);  // the size a request for this many limbs is rounded up to
+
+private:
+    struct Cache {
+        std::vector<void*> free_blocks[max_class + 1];
+        bool& alive;
+        explicit Cache(bool& alive) : alive(alive) {}
+        ~Cache();
+    };
+    static Cache* cache();  // this thread's free lists, or nullptr while the thread is exiting
+
+    static unsigned int size_class(size_t bytes);
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
 
-    BigInt sqrt();  // returns the square root of this BigInt
-    BigInt pow(BigInt);  // returns this BigInt to the power of another BigInt
-    BigInt mod_pow(BigInt, BigInt);  // returns the modular power as a BigInt
-    BigInt mod_inverse(BigInt);  // returns the modular inverse of this BigInt
-    bool is_prime();  // returns true if this BigInt is prime, false if not
-    BigInt gcd(BigInt);  // returns the greatest common denominator of this and another number
+inline LimbPool* LimbPool::instance() {
+    static LimbPool pool;
+    return &pool;
+}
 
-    int to_int();  // returns this BigInt expressed as an int
-    unsigned int to_uint();  // returns this BigInt expressed as an unsigned int
-    long int to_long_int();  // returns this BigInt expressed as a long int
-    long unsigned int to_long_uint();  // returns this BigInt expressed as a long unsigned int
-    long long int to_long_long_int();  // returns this BigInt expressed as a long long int
-    long long unsigned int to_long_long_uint();  // returns this BigInt expressed as a long long unsigned int
+// rounds up to the next class size (sizes above the largest class are left alone)
+inline size_t LimbPool::block_limbs(size_t limbs) {
+    if (limbs > ((size_t)1 << max_class)) {
+        return limbs;
+    }
+    size_t block = (size_t)1 << min_class;
+    while (block < limbs) {
+        block <<= 1;
+    }
+    return block;
+}
 
-    std::string to_string();  // returns this BigInt as a string
-};
+inline unsigned int LimbPool::size_class(size_t bytes) {
+    unsigned int k = min_class;
+    while (((size_t)sizeof(limb) << k) < bytes) {
+        k++;
+    }
+    return k;
+}
 
-// Comparisan Operator declarations
-inline bool operator==(BigInt lhs, const BigInt& rhs);
-inline bool operator!=(BigInt lhs, const BigInt& rhs);
-inline bool operator<(BigInt lhs, BigInt rhs);
-inline bool operator>(BigInt lhs, const BigInt& rhs);
-inline bool operator>=(BigInt lhs, const BigInt& rhs);
-inline bool operator<=(BigInt lhs, const BigInt& rhs);
+inline LimbPool::Cache* LimbPool::cache() {
+    thread_local bool alive = true;  // trivially destructible, so still readable after the cache is gone
+    if (!alive) {
+        return nullptr;
+    }
+    thread_local Cache local(alive);
+    return &local;
+}
 
+inline LimbPool::Cache::~Cache() {
+    alive = false;
+    for (std::vector<void*>& blocks : free_blocks) {
+        for (void* block : blocks) {
+            ::operator delete(block);
+        }
+    }
+}
 
-// ////////// Arithmetic Operators ////////// //
+inline void* LimbPool::do_allocate(size_t bytes, size_t) {
+    if (bytes > (sizeof(limb) << max_class)) {
+        return ::operator new(bytes);
+    }
+    unsigned int k = size_class(bytes);
+    Cache* local = cache();
+    if (local != nullptr && !local->free_blocks[k].empty()) {
+        void* block = local->free_blocks[k].back();
+        local->free_blocks[k].pop_back();
+        return block;
+    }
+    return ::operator new(sizeof(limb) << k);
+}
 
-// addition using the elementary algorithm
-BigInt& BigInt::operator+=(const BigInt& rhs) {
-    // uses the addition algorithm you learned in elementary school:
-    //    12321  (top bar)
-    //   +33333  (bottom bar)
-    //   ------
-    //    45654  (sum bar)
+inline void LimbPool::do_deallocate(void* p, size_t bytes, size_t) {
+    if (bytes <= (sizeof(limb) << max_class)) {
+        unsigned int k = size_class(bytes);
+        Cache* local = cache();
+        size_t limit = std::max<size_t>(2, std::min<size_t>(256, cache_bytes / (sizeof(limb) << k)));
+        if (local != nullptr && local->free_blocks[k].size() < limit) {
+            local->free_blocks[k].push_back(p);
+            return;
+        }
+    }
+    ::operator delete(p);
+}
 
-    BigInt top = rhs; // top bar
+// the resource new BigInts on this thread take their heap blocks from (nullptr: LimbPool)
+inline thread_local std::pmr::memory_resource* thread_limb_resource = nullptr;
 
-    // finds the length of the smaller number
-    int min = this->size();
-    if (top.size() < min) { min = top.size(); }
+// a per-thread bump allocator for kernel temporaries: a ScratchScope marks the arena on entry and releases
+// everything allocated after the mark on exit, so recursive algorithms (Karatsuba, long division) get their
+// buffers by moving a pointer, and the chunks are kept for the next call instead of being freed. Once nothing
+// is in use, chunks beyond retained_limbs are freed, so one huge operation doesn't pin its peak scratch memory
+// on the thread (and on every pool worker) for the life of the process
+class ScratchArena {
+public:
+    static ScratchArena& local();  // this thread's arena
+
+    struct Mark {
+        size_t chunk;
+        size_t used;
+    };
+    Mark mark() const;
+    void release(Mark);
+    limb* allocate(size_t);  // uninitialized limbs, valid until the enclosing scope is released
+
+    ~ScratchArena();
+
+private:
+    struct Chunk {
+        limb* data;
+        size_t size;
+        size_t used;
+    };
+    std::vector<Chunk> chunks;
+    size_t current = 0;  // the chunk allocations are taken from
+
+    static const size_t retained_limbs = (size_t)1 << 17;  // kept between operations (1 MiB)
+};
 
-    int max = this->size();
-    if (top.size() > max) { max = top.size(); }
+inline ScratchArena& ScratchArena::local() {
+    thread_local ScratchArena arena;
+    return arena;
+}
 
-    // reverses the numbers, so we can iterate left to right
-    std::reverse(this->number.begin(), this->number.end());
-    std::reverse(top.number.begin(), top.number.end());
+inline ScratchArena::Mark ScratchArena::mark() const {
+    return Mark{current, chunks.empty() ? 0 : chunks[current].used};
+}
 
-    // fills the smaller number with zeros so the lengths match
-    if (top.size() < max) {
-        while (top.size() < max) {
-            top.number.push_back(0);
-        }
-    }
-    else if (this->size() < max) {
-        while (this->size() < max) {
-            this->number.push_back(0);
-        }
+inline void ScratchArena::release(Mark mark) {
+    for (size_t i = mark.chunk + 1; i < chunks.size(); i++) {
+        chunks[i].used = 0;
     }
-
-    // creates the sum bar, initializes to zeros
-    BigInt sum;
-    sum.number = std::vector<int>(max+1, 0);
-
-    // adds the tops and bottom bars into the sum bar
-    for (int i = 0; i < max; i++) {
-        sum.number.at(i) = top.number.at(i) + this->number.at(i);
+    if (mark.chunk < chunks.size()) {
+        chunks[mark.chunk].used = mark.used;
     }
+    current = mark.chunk;
 
-    // adds the excess digits into the sum bar
-    for (int i = 0; i < max; i++) {
-        if (sum.number.at(i) > 9) {
-            sum.number.at(i) -= 10;
-            sum.number.at(i+1) += 1;
+    // the arena is empty: trim it back, newest (largest) chunks first
+    if (mark.chunk == 0 && mark.used == 0) {
+        size_t total = 0;
+        for (const Chunk& chunk : chunks) {
+            total += chunk.size;
+        }
+        while (total > retained_limbs) {
+            total -= chunks.back().size;
+            ::operator delete(chunks.back().data);
+            chunks.pop_back();
         }
     }
+}
 
-    // removes any excess zeros
-    for (int i = max; i >= 0; i--) {
-        if (sum.number.at(i) != 0) {
-            break;
-        }
-        else {
-            sum.number.pop_back();
+inline limb* ScratchArena::allocate(size_t n) {
+    for (; current < chunks.size(); current++) {
+        Chunk& chunk = chunks[current];
+        if (chunk.size - chunk.used >= n) {
+            limb* block = chunk.data + chunk.used;
+            chunk.used += n;
+            return block;
         }
     }
 
-    // reverses the sum bar back to normal
-    std::reverse(sum.number.begin(), sum.number.end());
-    this->number = sum.number; // sets the sum number as this number
-    return *this;
+    // out of room: a new chunk at least twice the last one, kept for reuse after this scope ends
+    size_t size = std::max<size_t>(n, chunks.empty() ? 4096 : 2 * chunks.back().size);
+    chunks.push_back(Chunk{static_cast<limb*>(::operator new(size * sizeof(limb))), size, n});
+    current = chunks.size() - 1;
+    return chunks.back().data;
 }
 
-inline BigInt operator+(BigInt lhs, const BigInt& rhs) {
-    lhs += rhs;
-    return lhs;
+inline ScratchArena::~ScratchArena() {
+    for (Chunk& chunk : chunks) {
+        ::operator delete(chunk.data);
+    }
 }
 
+// scratch space for one function call (ex: ScratchScope scratch; limb* t = scratch.allocate(2 * n);):
+// everything allocated through it is released when it goes out of scope
+class ScratchScope {
+public:
+    ScratchScope() : arena(ScratchArena::local()), start(arena.mark()) {}
+    ~ScratchScope() { arena.release(start); }
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    limb* allocate(size_t n) { return arena.allocate(n); }
+    limb* allocate_zeroed(size_t n) {
+        limb* block = arena.allocate(n);
+        std::fill(block, block + n, 0);
+        return block;
+    }
 
-// subtraction using the elementary "carry" algorithm
-BigInt& BigInt::operator-=(const BigInt& rhs) {
-    // uses the subtraction algorithm you learned in elementary school:
-    //    87654  (upper bar)
-    //   -33333  (lower bar)
-    //   ------
-    //    54321  (sum bar)
+private:
+    ScratchArena& arena;
+    ScratchArena::Mark start;
+};
 
-    BigInt result;
+}  // namespace bigint_detail
 
-    // sets the upper bar to the larger number
-    BigInt upper = *this;
-    BigInt lower = rhs;
 
-    if (lower > upper) {
-        result.negative = true;
-        upper = rhs;
-        lower = *this;
-    }
+// ////////// Limb Kernels ////////// //
 
-    // reverse the upper and lower bars, so we can iterate left to right
-    std::reverse( upper.number.begin(), upper.number.end() );
-    std::reverse( lower.number.begin(), lower.number.end() );
+// low-level routines on little-endian arrays of 64-bit limbs, shared by the BigInt operators
+// (ex: 2^64 + 5 is stored as {5, 1}); sizes are passed explicitly so the kernels never call the allocator, and
+// the ones that need no scratch space are constexpr so FixedInt can run them at compile time
+namespace bigint_detail {
 
-    // goes through each digit, subtraction (may get negative digits here, like {4, 3, -2, -5, 4})
-    for (int i = 0; i < lower.size(); i++) {
-        result.number.push_back(upper.number.at(i) - lower.number.at(i));
-    }
+typedef unsigned __int128 dlimb;  // twice as wide as a limb, holds a limb product plus carries
+
+const int limb_bits = 64;
+const limb decimal_base = 10000000000000000000ULL;  // 10^19, the largest power of 10 that fits in a limb
+const int decimal_base_digits = 19;
 
-    // adds any extra digits
-    for (int i = lower.size(); i < upper.size(); i++) {
-        result.number.push_back(upper.number.at(i));
+// the number of limbs of a[0 .. n) without leading zero limbs
+constexpr size_t significant_limbs(const limb* a, size_t n) {
+    while (n > 0 && a[n - 1] == 0) {
+        n--;
     }
+    return n;
+}
 
-    // deals with negatives by subtracting from the digit over
-    for (int i = 0; i < result.size(); i++) {
-        if (result.number.at(i) < 0) {
-            result.number.at(i+1) -= 1;
-            result.number.at(i) += 10;
+// compares two magnitudes without leading zero limbs: returns -1, 0 or 1
+constexpr int cmp(const limb* a, size_t an, const limb* b, size_t bn) {
+    if (an != bn) {
+        return an < bn ? -1 : 1;
+    }
+    for (size_t i = an; i-- > 0; ) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
         }
     }
+    return 0;
+}
 
-    // removes any extra zeros
-    while (result.size() != 0 && result.number.at(result.size()-1) == 0) {
-        result.number.pop_back();
+// r = a + b for an >= bn, returns the carry out of the top limb (r may be a or b)
+constexpr limb add(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    limb carry = 0;
+    size_t i = 0;
+    for (; i < bn; i++) {
+        dlimb sum = (dlimb)a[i] + b[i] + carry;
+        r[i] = (limb)sum;
+        carry = (limb)(sum >> limb_bits);
     }
-
-    // if the result is zero, ensure the number is empty
-    if (result.size() == 0) {
-        result.number = {};
+    for (; i < an; i++) {
+        limb sum = a[i] + carry;
+        carry = sum < carry;
+        r[i] = sum;
     }
+    return carry;
+}
 
-    // reverse back to normal
-    std::reverse( result.number.begin(), result.number.end() );
+// r = a + b for a single limb b, returns the carry out of the top limb (r may be a)
+constexpr limb add_1(limb* r, const limb* a, size_t n, limb b) {
+    for (size_t i = 0; i < n; i++) {
+        limb sum = a[i] + b;
+        b = sum < b;
+        r[i] = sum;
+    }
+    return b;
+}
 
-    this->number = result.number;  // set this number to the result number
-    return *this;
+// r = a - b for a >= b (an >= bn), returns the borrow out of the top limb (r may be a or b)
+constexpr limb sub(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    limb borrow = 0;
+    size_t i = 0;
+    for (; i < bn; i++) {
+        limb ai = a[i], bi = b[i];
+        r[i] = ai - bi - borrow;
+        borrow = (ai < bi) || (ai - bi < borrow);
+    }
+    for (; i < an; i++) {
+        limb ai = a[i];
+        r[i] = ai - borrow;
+        borrow = ai < borrow;
+    }
+    return borrow;
 }
 
-inline BigInt operator-(BigInt lhs, const BigInt& rhs) {
-    lhs -= rhs;
-    return lhs;
+// r = a * b for a single limb b, returns the high limb of the product (r may be a)
+constexpr limb mul_1(limb* r, const limb* a, size_t n, limb b) {
+    limb carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        dlimb product = (dlimb)a[i] * b + carry;
+        r[i] = (limb)product;
+        carry = (limb)(product >> limb_bits);
+    }
+    return carry;
 }
 
+// r += a * b for a single limb b, returns the limb carried out past r[n-1]
+constexpr limb addmul_1(limb* r, const limb* a, size_t n, limb b) {
+    limb carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        dlimb product = (dlimb)a[i] * b + r[i] + carry;
+        r[i] = (limb)product;
+        carry = (limb)(product >> limb_bits);
+    }
+    return carry;
+}
 
-// multiplication using the elementary algorithm
-BigInt& BigInt::operator*=(const BigInt& rhs) {
-    // uses the multiplication algorithm you learned in elementary school:
-    //      7654  (upper bar)
-    //   x    23  (lower bar)
-    //   -------
-    //     22962  (mult results)
-    //   +153080
-    //   -------
-    //    176042  (result)
+// r[0 .. an+bn) = a * b using the elementary algorithm, r must not overlap a or b
+constexpr void mul_basecase(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    r[an] = mul_1(r, a, an, b[0]);
+    for (size_t j = 1; j < bn; j++) {
+        r[an + j] = addmul_1(r + j, a, an, b[j]);
+    }
+}
 
+// the reciprocal of a normalized limb d (top bit set): floor((2^128 - 1) / d) - 2^64
+constexpr limb reciprocal(limb d) {
+    return (limb)(~(dlimb)0 / d);
+}
 
-    BigInt lhs = *this;
-    std::vector<BigInt> mult_results; // list of the additions results
-    int rhs_carry_size = rhs.number.size() + lhs.number.size(); // determines the max carry size
-    std::vector<int> rhs_carry(rhs_carry_size, 0); // initializes the carry to zeros
+// divides the two-limb number {high, low} by a normalized limb d with its precomputed reciprocal (high < d),
+// returns the quotient and stores the remainder: two multiplies instead of a 128-bit division (Moller-Granlund)
+constexpr limb divide_2by1(limb high, limb low, limb d, limb inverse, limb& remainder) {
+    dlimb estimate = (dlimb)inverse * high + (((dlimb)high << limb_bits) | low);
+    limb quotient = (limb)(estimate >> limb_bits) + 1;
+    limb r = low - quotient * d;
+    if (r > (limb)estimate) {
+        quotient--;
+        r += d;
+    }
+    if (r >= d) {
+        quotient++;
+        r -= d;
+    }
+    remainder = r;
+    return quotient;
+}
 
-    for (int i = lhs.size()-1; i >= 0; i--) { // for each on lower bar (going in reverse)
+// q = a / d for a single limb d, returns the remainder (q may be a)
+constexpr limb divrem_1(limb* q, const limb* a, size_t n, limb d) {
+    // normalizes d (and shifts a along with it on the fly) so the reciprocal trick applies
+    unsigned int shift = __builtin_clzll(d);
+    d <<= shift;
+    limb inverse = reciprocal(d);
 
-        for (unsigned int i = 0; i < rhs_carry.size(); i++) { // set carry to 0
-            rhs_carry.at(i) = 0;
+    limb remainder = 0;
+    if (shift != 0 && n > 0) {
+        remainder = a[n - 1] >> (limb_bits - shift);
+    }
+    for (size_t i = n; i-- > 0; ) {
+        limb low = a[i] << shift;
+        if (shift != 0 && i > 0) {
+            low |= a[i - 1] >> (limb_bits - shift);
         }
+        q[i] = divide_2by1(remainder, low, d, inverse, remainder);
+    }
+    return remainder >> shift;
+}
 
-        BigInt sub_result;
-        for (int k = 0; k < lhs.size()-1 - i; k++) { // push back initial zeroes
-            sub_result.number.push_back(0);
+// remainder of a magnitude divided by a single limb, without writing a quotient
+constexpr limb mod_1(const limb* a, size_t n, limb d) {
+    unsigned int shift = __builtin_clzll(d);
+    limb normalized = d << shift;
+    limb inverse = reciprocal(normalized);
+    limb remainder = 0;
+    if (shift != 0 && n > 0) {
+        remainder = a[n - 1] >> (limb_bits - shift);
+    }
+    for (size_t i = n; i-- > 0; ) {
+        limb low = a[i] << shift;
+        if (shift != 0 && i > 0) {
+            low |= a[i - 1] >> (limb_bits - shift);
         }
+        divide_2by1(remainder, low, normalized, inverse, remainder);
+    }
+    return remainder >> shift;
+}
 
-        for (int j = rhs.number.size()-1; j >= 0; j--) { // for each on upper bar
-            sub_result.number.push_back(lhs.number.at(i) * rhs.number.at(j) + rhs_carry.at(j)); // push back lower * upper + carry
-            
-            if (sub_result.number.at(sub_result.number.size()-1) > 9) { // if last number > 9
-                int new_digit = sub_result.number.at(sub_result.number.size()-1) % 10; // digit is the remainder / 10
-                if (j > 0) { // if upper bar not the last one
-                    rhs_carry.at(j-1) += sub_result.number.at(sub_result.number.size()-1) / 10; // increase carry 
-                    sub_result.number.at(sub_result.number.size()-1) = new_digit; // set digit
-                }
-                else { // if upper bar last one
-                    sub_result.number.push_back(sub_result.number.at(sub_result.number.size()-1) / 10); // push back carry
-                    sub_result.number.at(sub_result.number.size()-2) = new_digit; // set digit
-                }
-            }
-        }
-        std::reverse(sub_result.number.begin(), sub_result.number.end()); // reverse back to normal
-        mult_results.push_back(sub_result); // appends this sub result to the mult results for later addition
+// r -= a * b for a single limb b, returns the limb borrowed from past r[n-1]
+constexpr limb submul_1(limb* r, const limb* a, size_t n, limb b) {
+    limb borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        dlimb product = (dlimb)a[i] * b + borrow;
+        limb low = (limb)product;
+        borrow = (limb)(product >> limb_bits);
+        limb ri = r[i];
+        r[i] = ri - low;
+        borrow += ri < low;
     }
+    return borrow;
+}
 
-    // adds up all the mult results to get the final result
-    BigInt result(0);
-    for (BigInt i : mult_results) {
-        result = i + result;
+// q = a / d for an odd limb d that divides a exactly: multiplies by d's inverse mod 2^64 instead of dividing (q may be a)
+constexpr void divexact_1(limb* q, const limb* a, size_t n, limb d) {
+    limb inverse = d;  // Newton's iteration, each step doubles the number of correct low bits
+    for (int i = 0; i < 5; i++) {
+        inverse *= 2 - d * inverse;
     }
 
-    this->number = result.number;  // sets the result number into this number
-    return *this;
+    limb borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        limb ai = a[i];
+        limb x = ai - borrow;
+        borrow = ai < borrow;
+        limb digit = x * inverse;
+        q[i] = digit;
+        borrow += (limb)(((dlimb)digit * d) >> limb_bits);
+    }
 }
 
-inline BigInt operator*(BigInt lhs, BigInt rhs) {
-    lhs *= rhs;
-    return lhs;
+// r = a << shift for 0 < shift < 64, returns the bits shifted out of the top limb (r may be a)
+constexpr limb lshift(limb* r, const limb* a, size_t n, unsigned int shift) {
+    limb out = 0;
+    for (size_t i = 0; i < n; i++) {
+        limb ai = a[i];
+        r[i] = (ai << shift) | out;
+        out = ai >> (limb_bits - shift);
+    }
+    return out;
 }
 
-using namespace std;
-
-
-// division using the long division algorithm
-BigInt& BigInt::operator/=(const BigInt& rhs) {
-    // uses the long division algorithm to computer the division:
-    //    _102_
-    // 13|1326
-    BigInt lhs = *this;
-
-    // edge case: the outside is greater than the inside, result is zero (empty number)
-    if (rhs.size() > lhs.size()) { 
-        this->number = {};
-        return *this;
+// r = a >> shift for 0 < shift < 64, returns the bits shifted out of the bottom limb (r may be a)
+constexpr limb rshift(limb* r, const limb* a, size_t n, unsigned int shift) {
+    limb out = 0;
+    for (size_t i = n; i-- > 0; ) {
+        limb ai = a[i];
+        r[i] = (ai >> shift) | out;
+        out = ai << (limb_bits - shift);
     }
+    return out >> (limb_bits - shift);
+}
 
-    BigInt inside = lhs;
-    BigInt outside = rhs;
-    BigInt result;
+// r[0 .. 2n) = a * a, computing each cross product a[i]*a[j] once and doubling it, r must not overlap a
+constexpr void sqr_basecase(limb* r, const limb* a, size_t n) {
+    // cross products a[i]*a[j] for i < j
+    for (size_t i = 0; i < 2 * n; i++) {
+        r[i] = 0;
+    }
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[n + i] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    }
 
-    BigInt remainder;
+    // doubles them, then adds the squares on the diagonal
+    r[2 * n - 1] = lshift(r, r, 2 * n - 1, 1);
+    limb carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        dlimb square = (dlimb)a[i] * a[i];
+        dlimb low = (dlimb)r[2 * i] + (limb)square + carry;
+        r[2 * i] = (limb)low;
+        dlimb high = (dlimb)r[2 * i + 1] + (limb)(square >> limb_bits) + (limb)(low >> limb_bits);
+        r[2 * i + 1] = (limb)high;
+        carry = (limb)(high >> limb_bits);
+    }
+}
 
-    BigInt test;  // the temporary, recycled variable that travels along the inside digits
-    for (int i = 0; i < inside.size(); i++) {
-        if (!(test.size() == 0 && inside.number.at(i) == 0)) {
-            test.number.push_back(inside.number.at(i)); // adds the next digit to the test variable
+// q[0 .. an-bn] = a / b and r[0 .. bn) = a % b for an >= bn >= 2, using Knuth's Algorithm D:
+// the operands are shifted so b's top bit is set, then each quotient limb is estimated from the top
+// two limbs of the running remainder, corrected with b's second limb, and is off by at most one.
+// divisor[0 .. bn) and remainder[0 .. an] are caller-provided working space
+constexpr void divrem_knuth(limb* q, limb* r, const limb* a, size_t an, const limb* b, size_t bn, limb* divisor, limb* remainder) {
+    unsigned int shift = __builtin_clzll(b[bn - 1]);
+    if (shift != 0) {
+        lshift(divisor, b, bn, shift);
+        remainder[an] = lshift(remainder, a, an, shift);
+    }
+    else {
+        for (size_t i = 0; i < bn; i++) {
+            divisor[i] = b[i];
         }
-
-        // edge case: test is nothing
-        if (test.size() == 0) {
-            result.number.push_back(0);
-            test.number = {};
-            continue;
+        for (size_t i = 0; i < an; i++) {
+            remainder[i] = a[i];
         }
+        remainder[an] = 0;
+    }
 
-        // when test is less than the outside number (ex: the first operation of the example above, 1 < 13)
-        if (test < outside) {
-            result.number.push_back(0);
-            continue;
+    limb top = divisor[bn - 1], second = divisor[bn - 2];
+    limb inverse = reciprocal(top);
+    for (size_t j = an - bn + 1; j-- > 0; ) {
+        limb u2 = remainder[j + bn], u1 = remainder[j + bn - 1], u0 = remainder[j + bn - 2];
+
+        // estimate the quotient limb from the top two limbs of the remainder
+        limb estimate = 0, estimate_remainder = 0;
+        bool overflow = false;
+        if (u2 >= top) {
+            estimate = ~(limb)0;
+            estimate_remainder = u1 + top;
+            overflow = estimate_remainder < top;
         }
         else {
-            int counter = 0;
-            BigInt temp = test; // temp will decrease until it is less than the outside, so we know the result digit
-
-            while (outside <= temp) {
-                counter++;
-                temp = temp - outside;
+            estimate = divide_2by1(u2, u1, top, inverse, estimate_remainder);
+        }
 
-                if (temp == 0 && outside == 0) { break; } // redundancy edge case: it won't go lower than zero, so break there
+        // refine it with the divisor's second limb (at most two steps)
+        while (!overflow && (dlimb)estimate * second > (((dlimb)estimate_remainder << limb_bits) | u0)) {
+            estimate--;
+            estimate_remainder += top;
+            overflow = estimate_remainder < top;
+        }
 
-            }
-            result.number.push_back(counter);  // add the counter (aka the reult of this mini-division) to the result
-    
-            // whatever temp is now is the remainder, add this to test number
-            remainder = temp;  
-            test.number = {};
-            if (remainder != 0) {
-                for (int n : remainder.number) {  // iterates through the digits and appends to the number vector
-                    test.number.push_back(n);
-                }
-            }
+        // multiply and subtract; if that went negative the estimate was one too large, so add back
+        limb borrow = submul_1(remainder + j, divisor, bn, estimate);
+        limb high = remainder[j + bn];
+        remainder[j + bn] = high - borrow;
+        if (high < borrow) {
+            estimate--;
+            remainder[j + bn] += add(remainder + j, remainder + j, bn, divisor, bn);
         }
+        q[j] = estimate;
     }
 
-    BigInt filtered_result;  // filtered result will get rid of the excess zeros
-
-    // zeroes_flag is initially true until it encounters a non-zero digit, then it grabs all the remaining digits
-    // ex: 00012345 becomes 12345
-    bool zeroes_flag = true;
-    for (int i = 0; i < result.size(); i++) {
-        if (zeroes_flag == true) {
-            if (result.number.at(i) != 0) {
-                zeroes_flag = false;
-            }
-        }
-        
-        if (zeroes_flag == false) {
-            filtered_result.number.push_back(result.number.at(i));
+    // undo the normalization shift on the remainder
+    if (shift != 0) {
+        rshift(r, remainder, bn, shift);
+    }
+    else {
+        for (size_t i = 0; i < bn; i++) {
+            r[i] = remainder[i];
         }
     }
-
-    result = filtered_result;  // sets this filtered result to the overall result
-
-    this->number = result.number; // sets this number to the result number
-    return *this;
 }
 
-inline BigInt operator/(BigInt lhs, BigInt rhs) {
-    lhs /= BigInt(rhs);
-    return lhs;
+// same, with the working space taken from the thread's scratch arena
+inline void divrem_knuth(limb* q, limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    ScratchScope scratch;
+    limb* divisor = scratch.allocate(bn);
+    limb* remainder = scratch.allocate(an + 1);
+    divrem_knuth(q, r, a, an, b, bn, divisor, remainder);
 }
 
-// modulo using division and remainder
-BigInt& BigInt::operator%=(const BigInt& rhs) {
-    // *this % rhs --> divides this by rhs, and subtracts the result*rhs from this to get the modulo
-    BigInt division = *this / rhs;
-    BigInt mult = rhs * division;
-    BigInt result = *this - mult;
+}  // namespace bigint_detail
 
-    this->number = result.number;
-    return *this;
-}
 
-inline BigInt operator%(BigInt lhs, const BigInt& rhs) {
-    lhs %= rhs;
-    return lhs;
-}
+// ////////// Limb Storage ////////// //
 
+namespace bigint_detail {
 
-// ////////// Initializations ////////// //
+// a vector of limbs with room for a few of them inside the object itself: values up to 256 bits (every
+// int, every loop counter, most intermediate results) never touch the heap, and larger ones move to a heap
+// block that grows geometrically. Heap blocks come from a memory resource, fixed when the vector is
+// created (the thread's current one by default). Offers the subset of the std::vector interface the BigInt code uses
+class LimbVector {
+public:
+    typedef limb value_type;
+    typedef limb* iterator;
+    typedef const limb* const_iterator;
+
+    static const size_t inline_capacity = 4;
+
+    LimbVector();
+    explicit LimbVector(std::pmr::memory_resource*);  // empty, with heap blocks from the given resource (nullptr: LimbPool)
+    explicit LimbVector(size_t count, limb value = 0);
+    template <typename Iterator, typename = typename std::enable_if<!std::is_integral<Iterator>::value>::type>
+    LimbVector(Iterator first, Iterator last);
+    LimbVector(const LimbVector&);
+    LimbVector(LimbVector&&) noexcept;
+    ~LimbVector();
+
+    LimbVector& operator=(const LimbVector&);
+    LimbVector& operator=(LimbVector&&) noexcept;
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    bool is_inline() const { return data_ == local_; }  // true while the limbs live inside the object
+    std::pmr::memory_resource* resource() const { return resource_ ? resource_ : LimbPool::instance(); }
+
+    limb* data() { return data_; }
+    const limb* data() const { return data_; }
+    limb& operator[](size_t i) { return data_[i]; }
+    const limb& operator[](size_t i) const { return data_[i]; }
+    limb& at(size_t);  // bounds-checked, throws std::out_of_range
+    const limb& at(size_t) const;
+    limb& back() { return data_[size_ - 1]; }
+    const limb& back() const { return data_[size_ - 1]; }
+
+    iterator begin() { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+    void reserve(size_t);
+    void resize(size_t, limb = 0);  // new limbs are set to the given value (zero by default)
+    void assign(size_t, limb);
+    template <typename Iterator, typename = typename std::enable_if<!std::is_integral<Iterator>::value>::type>
+    void assign(Iterator first, Iterator last);
+    void push_back(limb);
+    void pop_back() { size_--; }
+    void clear() { size_ = 0; }
+    iterator insert(const_iterator, size_t, limb);  // inserts count copies of a limb before a position
+    iterator erase(const_iterator, const_iterator);
+    iterator erase(const_iterator position) { return erase(position, position + 1); }
+    void swap(LimbVector&);
+
+    bool operator==(const LimbVector&) const;
+    bool operator!=(const LimbVector& rhs) const { return !(*this == rhs); }
+
+private:
+    limb* data_;  // local_ or a heap block
+    size_t size_;
+    size_t capacity_;
+    std::pmr::memory_resource* resource_;  // nullptr for LimbPool, which skips the virtual call
+    limb local_[inline_capacity];
+
+    void reallocate(size_t);  // moves the limbs into a heap block of at least this capacity
+    void free_block();  // returns the heap block (if any) to its resource
+    bool same_resource(const LimbVector& other) const {
+        return resource_ == other.resource_ || resource()->is_equal(*other.resource());
+    }
+};
 
-// base initialization to empty number ("0")
-BigInt::BigInt() {
-    number = {};
-}
+inline LimbVector::LimbVector() : data_(local_), size_(0), capacity_(inline_capacity), resource_(thread_limb_resource) {}
 
-// initialization to another BigInt
-BigInt::BigInt(const BigInt& rhs) {
-    number = rhs.number;
+inline LimbVector::LimbVector(std::pmr::memory_resource* resource) : LimbVector() {
+    resource_ = resource == LimbPool::instance() ? nullptr : resource;
 }
 
-// initialization to a string 
-BigInt::BigInt(std::string rhs) {
-    initialize(rhs);
+inline LimbVector::LimbVector(size_t count, limb value) : LimbVector() {
+    assign(count, value);
 }
 
-// initialization to an int
-BigInt::BigInt(int rhs) {
-    initialize(std::to_string(rhs));
+template <typename Iterator, typename>
+inline LimbVector::LimbVector(Iterator first, Iterator last) : LimbVector() {
+    assign(first, last);
 }
 
-// initialization to a character/array
-BigInt::BigInt(const char* rhs) {
-    initialize(std::string(rhs));
+inline LimbVector::LimbVector(const LimbVector& other) : LimbVector() {
+    assign(other.begin(), other.end());
 }
 
-// catchall initialization function: takes a string, assigns each character to the number vector
-void BigInt::initialize(std::string source) {
-
-    number.resize(source.size());
-    for (unsigned int i = 0; i < source.size(); i++) {
-        number.at(i) = source.at(i) - '0';
+// a heap block is taken over as is (with its resource); inline limbs are copied (at most four of them)
+inline LimbVector::LimbVector(LimbVector&& other) noexcept : LimbVector() {
+    resource_ = other.resource_;
+    if (other.is_inline()) {
+        std::copy(other.begin(), other.end(), local_);
+        size_ = other.size_;
     }
-
-    // edge case: source = "0"
-    if (source == "0") {
-        number = {};
+    else {
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        other.data_ = other.local_;
+        other.capacity_ = inline_capacity;
     }
-    return;
+    other.size_ = 0;
 }
 
+inline LimbVector::~LimbVector() {
+    free_block();
+}
 
-// ////////// Conversion Functions ////////// //
+inline void LimbVector::free_block() {
+    if (is_inline()) {
+        return;
+    }
+    if (resource_ == nullptr) {
+        LimbPool::instance()->deallocate(data_, capacity_ * sizeof(limb), alignof(limb));
+    }
+    else {
+        resource_->deallocate(data_, capacity_ * sizeof(limb), alignof(limb));
+    }
+}
 
-// converts the number to string form: 12345 to "12345"
-std::string BigInt::to_string() {
-    std::string result;
-    for (int i : this->number) {
-        result += std::to_string(i);
+inline LimbVector& LimbVector::operator=(const LimbVector& other) {
+    if (this != &other) {
+        assign(other.begin(), other.end());
     }
-    return result;
+    return *this;
 }
 
-// converts the number to an integer
-int BigInt::to_int() {
-    return std::stoi(this->to_string());
+// a block from another resource can't be taken over, so the limbs are copied into this vector's own
+inline LimbVector& LimbVector::operator=(LimbVector&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    if (other.is_inline()) {
+        std::copy(other.begin(), other.end(), data_);  // every capacity holds at least the inline limbs
+        size_ = other.size_;
+    }
+    else if (!same_resource(other)) {
+        assign(other.begin(), other.end());
+    }
+    else {
+        free_block();
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        other.data_ = other.local_;
+        other.capacity_ = inline_capacity;
+    }
+    other.size_ = 0;
+    return *this;
 }
 
-// converts the number to an unsigned integer
-unsigned int BigInt::to_uint() {
-    return std::stoul(this->to_string());  // using stoul() as there is no stoui()
+inline limb& LimbVector::at(size_t i) {
+    if (i >= size_) {
+        throw std::out_of_range("LimbVector::at");
+    }
+    return data_[i];
 }
 
-// converts the number to a long integer
-long int BigInt::to_long_int() {
-    return std::stol(this->to_string());
+inline const limb& LimbVector::at(size_t i) const {
+    if (i >= size_) {
+        throw std::out_of_range("LimbVector::at");
+    }
+    return data_[i];
 }
 
-// converts the number to a long unsigned integer
-long unsigned int BigInt::to_long_uint() {
-    return std::stoul(this->to_string());
+inline void LimbVector::reallocate(size_t new_capacity) {
+    new_capacity = LimbPool::block_limbs(new_capacity);  // whole size classes, so freed blocks fit the next request
+    size_t bytes = new_capacity * sizeof(limb);
+    void* block = resource_ == nullptr ? LimbPool::instance()->allocate(bytes, alignof(limb)) : resource_->allocate(bytes, alignof(limb));
+    std::copy(begin(), end(), static_cast<limb*>(block));
+    free_block();
+    data_ = static_cast<limb*>(block);
+    capacity_ = new_capacity;
 }
 
-// converts the number to a long long integer
-long long int BigInt::to_long_long_int() {
-    return std::stoll(this->to_string());
+inline void LimbVector::reserve(size_t new_capacity) {
+    if (new_capacity > capacity_) {
+        reallocate(new_capacity);
+    }
 }
 
-// converts the number to a long long unsigned integer
-long long unsigned int BigInt::to_long_long_uint() {
-    return std::stoull(this->to_string());
+inline void LimbVector::resize(size_t count, limb value) {
+    if (count > capacity_) {
+        reallocate(std::max(count, 2 * capacity_));
+    }
+    if (count > size_) {
+        std::fill(data_ + size_, data_ + count, value);
+    }
+    size_ = count;
 }
 
+inline void LimbVector::assign(size_t count, limb value) {
+    size_ = 0;
+    resize(count, value);
+}
 
-// ////////// Assignment Operators ////////// //
+template <typename Iterator, typename>
+inline void LimbVector::assign(Iterator first, Iterator last) {
+    size_t count = std::distance(first, last);
+    size_ = 0;
+    reserve(count);
+    std::copy(first, last, data_);
+    size_ = count;
+}
 
-// asignment to another BigInt
-BigInt& BigInt::operator=(const BigInt rhs) {
-    number = rhs.number;
-    return *this;
+inline void LimbVector::push_back(limb value) {
+    if (size_ == capacity_) {
+        reallocate(2 * capacity_);
+    }
+    data_[size_++] = value;
 }
 
-// assignment to a char array (BigInt a = "123")
-BigInt& BigInt::operator=(const char* rhs) {
-  initialize(std::string(rhs));
-  return *this;
+inline LimbVector::iterator LimbVector::insert(const_iterator position, size_t count, limb value) {
+    size_t index = position - data_;
+    if (size_ + count > capacity_) {
+        reallocate(std::max(size_ + count, 2 * capacity_));
+    }
+    std::copy_backward(data_ + index, data_ + size_, data_ + size_ + count);
+    std::fill(data_ + index, data_ + index + count, value);
+    size_ += count;
+    return data_ + index;
 }
 
-// assignment to an integer (BigInt a = 123)
-BigInt& BigInt::operator=(const int& rhs) {
-  initialize(std::to_string(rhs));
-  return *this;
+inline LimbVector::iterator LimbVector::erase(const_iterator first, const_iterator last) {
+    size_t index = first - data_;
+    size_t count = last - first;
+    std::copy(data_ + index + count, data_ + size_, data_ + index);
+    size_ -= count;
+    return data_ + index;
 }
 
-// asignment to a string
-BigInt& BigInt::operator=(std::string rhs) {
-  initialize(rhs);
-  return *this;
+inline void LimbVector::swap(LimbVector& other) {
+    if (!is_inline() && !other.is_inline() && same_resource(other)) {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        return;
+    }
+    LimbVector temp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temp);
 }
 
-// assignment to a vector
-BigInt& BigInt::operator=(std::vector<int> rhs) {
-  number = rhs;
-  return *this;
+inline bool LimbVector::operator==(const LimbVector& rhs) const {
+    return size_ == rhs.size_ && std::equal(begin(), end(), rhs.begin());
 }
 
+}  // namespace bigint_detail
 
-// ////////// Stream Operators ////////// //
 
-// outstream (ex: cout << BigInt)
-std::ostream& operator<<(std::ostream& os, const BigInt& rhs) {
-    if (rhs.size() == 0) {
-        os << "0";
-    }
-    else {
-        for (int i : rhs.number) {
-            os << i;
-        }
-    }
-    return os;  
-}  
+class BigInt;
 
-// instream (ex: somestream >> BigInt)
-std::istream& operator>>(std::istream& is, BigInt& rhs) {
-    std::string input;
-    is >> input;
-    rhs = input;
-    return is;  
-}
+namespace bigint_detail {
 
+// the built-in integer types a BigInt converts to and from directly (bool aside, __int128 included)
+template <typename T>
+struct is_native_integer : std::integral_constant<bool,
+    (std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+    std::is_same<T, __int128>::value || std::is_same<T, unsigned __int128>::value> {};
 
-// ////////// Comparisan Operators ////////// //
+// the ones that fit in a limb, which the arithmetic operators take as they are
+template <typename T>
+struct is_limb_integer : std::integral_constant<bool, is_native_integer<T>::value && sizeof(T) <= sizeof(limb)> {};
 
-bool operator==(BigInt lhs, const BigInt& rhs) {
-  if (lhs.size() != rhs.size()) {
-    return false;
-  }
-  for (int i = 0; i < lhs.size(); i++) {
-    if (rhs.number.at(i) != lhs.number.at(i)) {
-        return false;
-    }
-  }
-  return true;
-}
+template <typename T, typename R>
+using if_native_integer = typename std::enable_if<is_native_integer<T>::value, R>::type;
 
-bool operator!=(BigInt lhs, const BigInt& rhs) {
-    return !(lhs == rhs);
-}
+template <typename T, typename R>
+using if_limb_integer = typename std::enable_if<is_limb_integer<T>::value, R>::type;
 
-bool operator<(BigInt lhs, BigInt rhs) {
-    if (lhs.size() == 0 && rhs.size() != 0) {
-        return true;
-    }
+// R when B is BigInt and T fits in a limb: picks out BigInt-and-integer operands without letting anything
+// that merely converts to BigInt (ex: a lazy expression) match
+template <typename B, typename T, typename R>
+using if_mixed = typename std::enable_if<std::is_same<B, BigInt>::value && is_limb_integer<T>::value, R>::type;
 
-    if (lhs.size() != 0 && rhs.size() == 0) {
-        return false;
-    }
+// splits a native integer into a magnitude and a sign (exact for the most negative value too)
+template <typename T>
+constexpr limb native_magnitude(T value, bool& negative) {
+    negative = T(-1) < T(0) && value < T(0);
+    return negative ? 0 - (limb)value : (limb)value;
+}
 
-    if (lhs == BigInt(0) && rhs == BigInt(0)) {
-        return false;
-    }
+}  // namespace bigint_detail
 
-    if (lhs.negative == true && rhs.negative == false) {
-        return true;
-    }
 
-    if (lhs.negative == false && rhs.negative == true) {
-        return false;
-    }
+// the primality tests BigInt::is_prime can run
+enum class PrimalityTest {
+    deterministic,  // Miller-Rabin with a fixed witness set that is proven exact below 3.3 * 10^24 (Baillie-PSW above that)
+    baillie_psw,  // Miller-Rabin to base 2 plus a strong Lucas test: no known counterexample, exact below 2^64
+    miller_rabin  // the given number of Miller-Rabin rounds with random bases: a composite passes with probability < 4^-rounds
+};
 
-    if (lhs.negative == true && rhs.negative == true) {
-        if (lhs.size() < rhs.size()) {
+// the order of the bytes in to_bytes / from_bytes
+enum class ByteOrder {
+    big_endian,  // most significant byte first (the usual order for cryptographic formats)
+    little_endian  // least significant byte first (the order of the limbs in memory)
+};
+
+// how multiplication and division run (set BigInt::execution_policy, or use an ExecutionScope for one thread)
+enum class ExecutionPolicy {
+    sequential,  // everything on the calling thread
+    parallel  // sub-products of at least BigInt::parallel_threshold limbs are forked onto a work-stealing thread pool
+};
+
+
+class BigInt {
+public:
+    typedef bigint_detail::limb limb;  // one base 2^64 "digit" of the number
+
+    bigint_detail::LimbVector number;  // holds the magnitude as little-endian 64-bit limbs (ex: 2^64 + 5 is {5, 1}), empty for 0, inline up to 4 limbs
+    void initialize(std::string);  // Generates this BigInt's number vector from an std::string input
+    template <typename T>
+    void initialize_native(T);  // Generates this BigInt's number vector from a built-in integer, keeping its buffer
+
+    unsigned int size() const;  // returns the size (number of 64-bit limbs) of the BigInt
+    bool negative = false;  // By default, the BigInt is not set to be negative
+    void trim();  // removes leading zero limbs, and the sign from a zero
+    void swap(BigInt&);  // exchanges values with another BigInt without copying the limbs
+    size_t bit_length() const;  // returns the number of bits in the magnitude (0 for 0)
+    bool test_bit(size_t) const;  // returns bit i of the magnitude (bit 0 is the lowest)
+
+    BigInt();  // ex: BigInt a()
+    BigInt(const BigInt&);
+    BigInt(BigInt&&) noexcept;  // takes over the limbs of an expiring BigInt (ex: BigInt a = b * c)
+    BigInt(int);  // ex: BigInt a(135)
+    template <typename T, typename = typename std::enable_if<bigint_detail::is_native_integer<T>::value>::type>
+    BigInt(T);  // ex: BigInt a(135ULL), BigInt b((__int128)1 << 100) (straight into limbs, for any built-in integer type)
+    BigInt(std::string);  // ex: BigInt a(string("135"))
+    BigInt(const char*);  // ex: BigInt a("135")
+    explicit BigInt(std::pmr::memory_resource*);  // ex: BigInt a(&someArena) (zero, with heap limbs from the given resource)
+
+    std::pmr::memory_resource* memory_resource() const;  // returns the resource this BigInt's heap limbs come from
+    static void set_memory_resource(std::pmr::memory_resource*);  // sets the resource for BigInts created later on this thread (nullptr: the built-in pool)
+
+    BigInt& operator=(const BigInt&);  // ex: BigInt a = someBigInt
+    BigInt& operator=(BigInt&&) noexcept;  // ex: a = b * c (reuses the result's limbs instead of copying them)
+    BigInt& operator=(const char*);  // ex: BigInt a = "135"
+    BigInt& operator=(const int&);  // ex: BigInt a = 135
+    template <typename T>
+    bigint_detail::if_native_integer<T, BigInt&> operator=(T);  // ex: a = 135ULL
+    BigInt& operator=(std::string);  // ex: BigInt a = std::string("135")
+    BigInt& operator=(std::vector<int>);  // ex: BigInt a = std::vector({1, 3, 5})
+
+    BigInt& operator+=(const BigInt&);  // ex: a += 5
+    BigInt& operator-=(const BigInt&);  // ex: a -= 5
+    BigInt& operator*=(const BigInt&);  // ex: a *= 5
+    BigInt& operator/=(const BigInt&);  // ex: a /= 5
+    BigInt& operator%=(const BigInt&);  // ex: a %= 5
+    BigInt& add_signed(const BigInt&, bool);  // adds a BigInt's magnitude with the given sign (shared by += and -=)
+    BigInt& add_signed(limb, bool);  // same for a single-limb magnitude
+
+    // the same operators for a built-in integer, in one pass over the limbs (or O(1)) without converting it to a BigInt
+    template <typename T> bigint_detail::if_limb_integer<T, BigInt&> operator+=(T);  // ex: a += 5
+    template <typename T> bigint_detail::if_limb_integer<T, BigInt&> operator-=(T);  // ex: a -= 5
+    template <typename T> bigint_detail::if_limb_integer<T, BigInt&> operator*=(T);  // ex: a *= 5
+    template <typename T> bigint_detail::if_limb_integer<T, BigInt&> operator/=(T);  // ex: a /= 5
+    template <typename T> bigint_detail::if_limb_integer<T, BigInt&> operator%=(T);  // ex: a %= 5 (O(1) for powers of two, so a % 2 == 1 is cheap)
+
+    static unsigned int karatsuba_threshold;  // operands with at least this many limbs multiply with Karatsuba
+    static unsigned int toom3_threshold;  // operands with at least this many limbs multiply with Toom-3
+    static unsigned int ntt_threshold;  // operands with at least this many limbs multiply with the number-theoretic transform
+    static unsigned int burnikel_ziegler_threshold;  // divisors with at least this many limbs divide recursively (Burnikel-Ziegler)
+    static unsigned int lehmer_threshold;  // gcd operands with at least this many limbs use Lehmer's algorithm instead of binary GCD
+    static unsigned int decimal_conversion_threshold;  // numbers with at least this many limbs convert to and from decimal by divide and conquer
+    static unsigned int parallel_threshold;  // with ExecutionPolicy::parallel, products with at least this many limbs split across threads
+    static ExecutionPolicy execution_policy;  // the policy for threads without an ExecutionScope (sequential by default)
+    static unsigned int thread_count();  // returns the number of threads parallel work runs on, counting the caller
+    static void set_thread_count(unsigned int);  // sets it (0: one per core), restarting the pool; call while no parallel work runs
+
+    BigInt& operator++(int);  // postfix increment
+    BigInt& operator++();  // prefix increment
+
+    BigInt& operator--(int);  // postfix decrement
+    BigInt& operator--();  // prefix decrement
+
+    BigInt& operator<<=(size_t);  // ex: a <<= 3 (multiplies by 2^3)
+    BigInt& operator>>=(size_t);  // ex: a >>= 3 (divides by 2^3, rounding down like an arithmetic shift: -5 >> 1 == -3)
+
+    friend std::ostream& operator<<(std::ostream&, const BigInt&);  // output the BigInt onto an stream (ex: someOutputStream << someBigInt)
+    friend std::istream& operator>>(std::istream&, const BigInt&);  // read form a stream into a BigInt (ex: someInputStream >> someBigInt)
+
+    BigInt sqrt() const;  // returns the square root of this BigInt (rounded down)
+    std::pair<BigInt, BigInt> sqrtrem() const;  // returns the square root and the remainder (ex: 10 -> {3, 1})
+    BigInt iroot(unsigned int) const;  // returns the k-th root of this BigInt (ex: BigInt(1000).iroot(3) == 10)
+    BigInt pow(BigInt);  // returns this BigInt to the power of another BigInt
+    BigInt mod_pow(BigInt, BigInt);  // returns the modular power as a BigInt
+    BigInt mod_pow(BigInt, BigInt, bool);  // same, but with a constant-time fixed window when the flag is set (for secret exponents, odd moduli)
+    BigInt mod_inverse(BigInt);  // returns the modular inverse of this BigInt
+    bool is_prime();  // returns true if this BigInt is prime, false if not (deterministic below 2^64, Baillie-PSW above)
+    bool is_prime(PrimalityTest, unsigned int = 25);  // same, with a chosen test (and number of rounds for PrimalityTest::miller_rabin)
+    BigInt gcd(BigInt);  // returns the greatest common denominator of this and another number
+
+    int to_int() const;  // returns this BigInt expressed as an int
+    unsigned int to_uint() const;  // returns this BigInt expressed as an unsigned int
+    long int to_long_int() const;  // returns this BigInt expressed as a long int
+    long unsigned int to_long_uint() const;  // returns this BigInt expressed as a long unsigned int
+    long long int to_long_long_int() const;  // returns this BigInt expressed as a long long int
+    long long unsigned int to_long_long_uint() const;  // returns this BigInt expressed as a long long unsigned int
+    __int128 to_int128() const;  // returns this BigInt expressed as an __int128
+    unsigned __int128 to_uint128() const;  // returns this BigInt expressed as an unsigned __int128
+    template <typename T>
+    T to_native() const;  // returns this BigInt as any built-in integer type (the to_ functions above all throw std::out_of_range if it does not fit)
+
+    std::string to_string() const;  // returns this BigInt as a string
+
+    size_t byte_length() const;  // returns the number of bytes in the magnitude (0 for 0)
+    std::vector<uint8_t> to_bytes(ByteOrder = ByteOrder::big_endian) const;  // returns the magnitude in byte_length() bytes (ex: 258 -> {1, 2})
+    std::vector<uint8_t> to_bytes(size_t, ByteOrder = ByteOrder::big_endian) const;  // same, zero-padded to a fixed width (ex: to_bytes(32)), throws std::out_of_range if wider
+    void export_bytes(uint8_t*, size_t, ByteOrder = ByteOrder::big_endian) const;  // same, into caller memory of that width (ex: a.export_bytes(buffer, 32))
+    void import_bytes(const uint8_t*, size_t, ByteOrder = ByteOrder::big_endian);  // sets this BigInt to a magnitude in caller memory, reusing its limbs
+    static BigInt from_bytes(const uint8_t*, size_t, ByteOrder = ByteOrder::big_endian);  // ex: BigInt::from_bytes(buffer, 32)
+    static BigInt from_bytes(const std::vector<uint8_t>&, ByteOrder = ByteOrder::big_endian);  // ex: BigInt::from_bytes(a.to_bytes()) == abs(a)
+
+    size_t framed_size() const;  // returns the size of this BigInt's frame (varint header, then the magnitude)
+    uint8_t* write_framed(uint8_t*) const;  // writes the frame into caller memory of at least framed_size() bytes, returns its end
+    const uint8_t* read_framed(const uint8_t*, const uint8_t*);  // sets this BigInt from the frame at [begin, end), returns where it ends (throws std::invalid_argument if cut short)
+};
+
+// Arithmetic Operator declarations (a left operand is taken by value so an expiring one is reused; the
+// BigInt&& overloads do the same for an expiring right operand)
+inline BigInt operator+(BigInt lhs, const BigInt& rhs);
+inline BigInt operator+(const BigInt& lhs, BigInt&& rhs);
+inline BigInt operator-(BigInt lhs, const BigInt& rhs);
+inline BigInt operator-(const BigInt& lhs, BigInt&& rhs);
+inline BigInt operator*(BigInt lhs, const BigInt& rhs);
+inline BigInt operator*(const BigInt& lhs, BigInt&& rhs);
+inline BigInt operator/(BigInt lhs, const BigInt& rhs);
+inline BigInt operator<<(BigInt lhs, size_t shift);
+inline BigInt operator>>(BigInt lhs, size_t shift);
+inline BigInt operator%(BigInt lhs, const BigInt& rhs);
+inline void divmod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder);
+inline std::pair<BigInt, BigInt> divmod(const BigInt& a, const BigInt& b);
+inline std::tuple<BigInt, BigInt, BigInt> xgcd(const BigInt& a, const BigInt& b);
+inline BigInt multiply(ExecutionPolicy policy, const BigInt& a, const BigInt& b);  // ex: c = multiply(ExecutionPolicy::parallel, a, b)
+inline std::pair<BigInt, BigInt> divmod(ExecutionPolicy policy, const BigInt& a, const BigInt& b);  // ex: divmod(ExecutionPolicy::parallel, a, b)
+inline std::vector<uint8_t> to_framed(const std::vector<BigInt>& values);  // ex: to_framed({a, b, c}) (the frames back to back)
+inline std::vector<BigInt> from_framed(const uint8_t* data, size_t size);  // ex: from_framed(buffer, length), throws std::invalid_argument on malformed data
+inline std::vector<BigInt> from_framed(const std::vector<uint8_t>& bytes);
+inline BigInt next_prime(const BigInt& n);  // ex: next_prime(100) == 101 (the smallest prime greater than n)
+inline BigInt random_prime(size_t bits);  // ex: random_prime(1024) (a random 1024-bit prime, from std::random_device)
+inline BigInt random_safe_prime(size_t bits);  // ex: random_safe_prime(512) (p and (p - 1) / 2 both prime)
+template <typename Generator> inline BigInt random_prime(size_t bits, Generator& generator);  // ex: random_prime(256, someMt19937)
+template <typename Generator> inline BigInt random_safe_prime(size_t bits, Generator& generator);
+
+// Comparisan Operator declarations
+inline bool operator==(const BigInt& lhs, const BigInt& rhs);
+inline bool operator!=(const BigInt& lhs, const BigInt& rhs);
+inline bool operator<(const BigInt& lhs, const BigInt& rhs);
+inline bool operator>(const BigInt& lhs, const BigInt& rhs);
+inline bool operator>=(const BigInt& lhs, const BigInt& rhs);
+inline bool operator<=(const BigInt& lhs, const BigInt& rhs);
+
+// Native Integer Operator declarations (ex: a * 2, 1 + a, a % 2 == 1)
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, BigInt> operator+(L lhs, T rhs);
+template <typename T, typename R> inline bigint_detail::if_mixed<R, T, BigInt> operator+(T lhs, R rhs);
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, BigInt> operator-(L lhs, T rhs);
+template <typename T, typename R> inline bigint_detail::if_mixed<R, T, BigInt> operator-(T lhs, R rhs);
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, BigInt> operator*(L lhs, T rhs);
+template <typename T, typename R> inline bigint_detail::if_mixed<R, T, BigInt> operator*(T lhs, R rhs);
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, BigInt> operator/(L lhs, T rhs);
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, BigInt> operator%(L lhs, T rhs);
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, bool> operator==(const L& lhs, T rhs);
+template <typename T, typename R> inline bigint_detail::if_mixed<R, T, bool> operator==(T lhs, const R& rhs);
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, bool> operator!=(const L& lhs, T rhs);
+template <typename T, typename R> inline bigint_detail::if_mixed<R, T, bool> operator!=(T lhs, const R& rhs);
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, bool> operator<(const L& lhs, T rhs);
+template <typename T, typename R> inline bigint_detail::if_mixed<R, T, bool> operator<(T lhs, const R& rhs);
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, bool> operator>(const L& lhs, T rhs);
+template <typename T, typename R> inline bigint_detail::if_mixed<R, T, bool> operator>(T lhs, const R& rhs);
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, bool> operator<=(const L& lhs, T rhs);
+template <typename T, typename R> inline bigint_detail::if_mixed<R, T, bool> operator<=(T lhs, const R& rhs);
+template <typename L, typename T> inline bigint_detail::if_mixed<L, T, bool> operator>=(const L& lhs, T rhs);
+template <typename T, typename R> inline bigint_detail::if_mixed<R, T, bool> operator>=(T lhs, const R& rhs);
+
+
+// ////////// Parallel Execution ////////// //
+
+// with ExecutionPolicy::parallel, the multiplication engine forks independent sub-products (the Karatsuba
+// and Toom-3 pieces, the rows of an unbalanced product, the three NTT primes and the butterflies of each
+// transform) as tasks onto a pool of worker threads. Each worker keeps a queue of its own tasks, newest
+// first, and steals the oldest task of another queue when its own is empty; a thread waiting for its tasks
+// runs queued tasks meanwhile, so nested forks never leave a thread idle or deadlock
+inline unsigned int BigInt::parallel_threshold = 1000;
+inline ExecutionPolicy BigInt::execution_policy = ExecutionPolicy::sequential;
+
+// sets the execution policy for everything the current thread does in this scope, whatever BigInt::execution_policy
+// says (ex: { ExecutionScope scope(ExecutionPolicy::parallel); f = factorial(1000000); })
+class ExecutionScope {
+public:
+    explicit ExecutionScope(ExecutionPolicy);
+    ~ExecutionScope();
+    ExecutionScope(const ExecutionScope&) = delete;
+    ExecutionScope& operator=(const ExecutionScope&) = delete;
+
+private:
+    std::optional<ExecutionPolicy> previous;
+};
+
+namespace bigint_detail {
+
+// the policy set by an ExecutionScope on this thread (worker threads always run parallel)
+inline thread_local std::optional<ExecutionPolicy> thread_execution_policy;
+
+inline unsigned int configured_thread_count = 0;  // 0: one per core
+
+class TaskGroup;
+
+// a unit of forked work, and the group waiting for it
+struct Task {
+    std::function<void()> work;
+    TaskGroup* group;
+};
+
+// the work-stealing pool: worker i owns queue i, and threads outside the pool share the last queue
+class ThreadPool {
+public:
+    static ThreadPool& instance();  // started on first use with BigInt::thread_count() - 1 workers
+    static void shut_down();  // joins the workers (the next instance() starts new ones)
+
+    void push(Task);  // onto the calling thread's queue
+    bool run_one();  // runs one queued task, this thread's newest or else the oldest of another queue; false if there was none
+
+    explicit ThreadPool(unsigned int workers);
+    ~ThreadPool();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    bool take(size_t queue, bool newest, Task&);
+    void work(size_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    static std::mutex& instance_mutex();
+    static std::unique_ptr<ThreadPool>& current();
+};
+
+// the pool and queue index of a worker thread (nullptr on other threads)
+inline thread_local ThreadPool* worker_pool = nullptr;
+inline thread_local size_t worker_index = 0;
+
+// fork-join over the pool (ex: TaskGroup group; group.run([&] { left = x * y; }); right = z * w; group.wait();)
+class TaskGroup {
+public:
+    TaskGroup() = default;
+    ~TaskGroup();  // waits too, so an exception leaving the forking function never leaves a task using its stack
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename Work>
+    void run(Work&&);  // queues the work, for this or any other thread to run
+    void wait();  // runs queued tasks until all of this group's are done, then rethrows the first exception one threw
+
+private:
+    friend class ThreadPool;
+    void join();
+    void fail(std::exception_ptr);
+    void finish();  // one task is done (the last one wakes join)
+
+    static const size_t spin_limit = 64;  // empty polls of the queues before join sleeps on a stolen task
+
+    ThreadPool* pool = nullptr;  // resolved on the first run (nullptr: nothing was forked)
+    std::atomic<size_t> pending{0};
+    std::mutex done_mutex;
+    std::condition_variable done;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+};
+
+inline std::mutex& ThreadPool::instance_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+inline std::unique_ptr<ThreadPool>& ThreadPool::current() {
+    static std::unique_ptr<ThreadPool> pool;
+    return pool;
+}
+
+inline ThreadPool& ThreadPool::instance() {
+    std::lock_guard<std::mutex> lock(instance_mutex());
+    std::unique_ptr<ThreadPool>& pool = current();
+    if (pool == nullptr) {
+        pool.reset(new ThreadPool(BigInt::thread_count() - 1));
+    }
+    return *pool;
+}
+
+inline void ThreadPool::shut_down() {
+    std::lock_guard<std::mutex> lock(instance_mutex());
+    current().reset();
+}
+
+inline ThreadPool::ThreadPool(unsigned int count) {
+    for (unsigned int i = 0; i <= count; i++) {
+        queues.emplace_back(new Queue);
+    }
+    for (unsigned int i = 0; i < count; i++) {
+        workers.emplace_back(&ThreadPool::work, this, (size_t)i);
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+inline void ThreadPool::push(Task task) {
+    size_t own = worker_pool == this ? worker_index : queues.size() - 1;
+    {
+        std::lock_guard<std::mutex> lock(queues[own]->mutex);
+        queues[own]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+inline bool ThreadPool::take(size_t index, bool newest, Task& task) {
+    Queue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    if (newest) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+    }
+    else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+    }
+    queued--;
+    return true;
+}
+
+// the newest of its own tasks is the one whose data is still in cache; stolen tasks are the oldest, so
+// usually the largest piece of someone else's recursion
+inline bool ThreadPool::run_one() {
+    size_t own = worker_pool == this ? worker_index : queues.size() - 1;
+    Task task;
+    bool found = take(own, true, task);
+    for (size_t i = 1; !found && i < queues.size(); i++) {
+        found = take((own + i) % queues.size(), false, task);
+    }
+    if (!found) {
+        return false;
+    }
+    try {
+        task.work();
+    }
+    catch (...) {
+        task.group->fail(std::current_exception());
+    }
+    task.group->finish();
+    return true;
+}
+
+inline void ThreadPool::work(size_t index) {
+    worker_pool = this;
+    worker_index = index;
+    thread_execution_policy = ExecutionPolicy::parallel;
+    while (true) {
+        if (run_one()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [&]() { return stopping || queued > 0; });
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+// the pool is looked up once per group, and not at all on a worker thread, so forking many tasks never
+// contends on the lock guarding the pool's creation
+template <typename Work>
+inline void TaskGroup::run(Work&& work) {
+    if (pool == nullptr) {
+        pool = worker_pool != nullptr ? worker_pool : &ThreadPool::instance();
+    }
+    pending.fetch_add(1, std::memory_order_relaxed);
+    pool->push(Task{std::function<void()>(std::forward<Work>(work)), this});
+}
+
+// runs queued tasks while there are any; once the rest are all running on other threads, spins briefly in
+// case they are short, then sleeps until the last one finishes
+inline void TaskGroup::join() {
+    if (pool == nullptr) {
+        return;  // nothing was forked (the sequential path never starts the pool)
+    }
+    for (size_t idle = 0; idle < spin_limit && pending.load(std::memory_order_acquire) > 0;) {
+        if (pool->run_one()) {
+            idle = 0;
+        }
+        else {
+            idle++;
+            std::this_thread::yield();
+        }
+    }
+    // (always taken, even with nothing pending, so a finishing thread is out of finish() before this group can be destroyed)
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&]() { return pending.load(std::memory_order_acquire) == 0; });
+}
+
+inline void TaskGroup::finish() {
+    std::lock_guard<std::mutex> lock(done_mutex);
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        done.notify_all();
+    }
+}
+
+inline void TaskGroup::wait() {
+    join();
+    if (error) {
+        std::exception_ptr first = error;
+        error = nullptr;
+        std::rethrow_exception(first);
+    }
+}
+
+inline TaskGroup::~TaskGroup() {
+    join();
+}
+
+inline void TaskGroup::fail(std::exception_ptr exception) {
+    std::lock_guard<std::mutex> lock(error_mutex);
+    if (!error) {
+        error = exception;
+    }
+}
+
+// true if the calling thread runs under ExecutionPolicy::parallel, with more than one thread to run on
+inline bool parallel_enabled() {
+    return thread_execution_policy.value_or(BigInt::execution_policy) == ExecutionPolicy::parallel && BigInt::thread_count() > 1;
+}
+
+// true if work on operands of this many limbs should be split across threads
+inline bool parallel_active(size_t limbs) {
+    return limbs >= BigInt::parallel_threshold && parallel_enabled();
+}
+
+// calls body(begin, end) on consecutive ranges covering [0, count), forked across the pool in pieces of at least grain
+template <typename Body>
+inline void parallel_for(size_t count, size_t grain, const Body& body) {
+    size_t pieces = std::min<size_t>(count / std::max<size_t>(grain, 1), 4 * BigInt::thread_count());
+    if (pieces <= 1) {
+        body(0, count);
+        return;
+    }
+    size_t step = (count + pieces - 1) / pieces;
+    TaskGroup group;
+    for (size_t begin = step; begin < count; begin += step) {
+        size_t end = std::min(begin + step, count);
+        group.run([&body, begin, end]() { body(begin, end); });
+    }
+    body(0, step);
+    group.wait();
+}
+
+}  // namespace bigint_detail
+
+inline ExecutionScope::ExecutionScope(ExecutionPolicy policy) : previous(bigint_detail::thread_execution_policy) {
+    bigint_detail::thread_execution_policy = policy;
+}
+
+inline ExecutionScope::~ExecutionScope() {
+    bigint_detail::thread_execution_policy = previous;
+}
+
+inline unsigned int BigInt::thread_count() {
+    unsigned int count = bigint_detail::configured_thread_count;
+    if (count == 0) {
+        count = std::thread::hardware_concurrency();
+    }
+    return std::max(count, 1u);
+}
+
+inline void BigInt::set_thread_count(unsigned int count) {
+    bigint_detail::ThreadPool::shut_down();
+    bigint_detail::configured_thread_count = count;
+}
+
+
+// ////////// Multiplication Engine ////////// //
+
+// the crossover points are tunable: set BigInt::karatsuba_threshold / toom3_threshold / ntt_threshold before multiplying
+inline unsigned int BigInt::karatsuba_threshold = 32;
+inline unsigned int BigInt::toom3_threshold = 300;
+inline unsigned int BigInt::ntt_threshold = 20000;
+
+namespace bigint_detail {
+
+inline void mul(limb* r, const limb* a, size_t an, const limb* b, size_t bn);
+
+// how many scratch limbs mul_karatsuba needs for n-limb operands (each level keeps two sums and their product)
+inline size_t karatsuba_scratch_size(size_t n) {
+    size_t total = 0;
+    while (n >= 4) {
+        size_t high = n - n / 2;
+        total += 4 * (high + 1);
+        n = high + 1;
+    }
+    return total + 4;
+}
+
+// r[0 .. 2n) = a * b for two n-limb operands using Karatsuba's method, r must not overlap a or b:
+// with a = a1*B^h + a0 and b = b1*B^h + b0, three half-size products replace four
+//    a*b = a1*b1*B^2h + ((a0+a1)*(b0+b1) - a0*b0 - a1*b1)*B^h + a0*b0
+inline void mul_karatsuba(limb* r, const limb* a, const limb* b, size_t n, limb* scratch) {
+    bool square = a == b;
+    if (n < BigInt::karatsuba_threshold || n < 4) {
+        if (square) {
+            sqr_basecase(r, a, n);
+        }
+        else {
+            mul_basecase(r, a, n, b, n);
+        }
+        return;
+    }
+
+    size_t low = n / 2;
+    size_t high = n - low;  // high >= low, the sums have high limbs plus a carry limb
+    limb* sum_a = scratch;
+    limb* sum_b = sum_a + high + 1;
+    limb* middle = sum_b + high + 1;
+    limb* rest = middle + 2 * (high + 1);
+
+    // (a0+a1)*(b0+b1), a0*b0 in the bottom of r and a1*b1 in the top (they don't overlap); in parallel the
+    // two outer products are forked, each with scratch of its own
+    sum_a[high] = add(sum_a, a + low, high, a, low);
+    if (!square) {
+        sum_b[high] = add(sum_b, b + low, high, b, low);
+    }
+    TaskGroup group;
+    if (parallel_active(n)) {
+        group.run([=]() {
+            ScratchScope own;
+            mul_karatsuba(r, a, b, low, own.allocate(karatsuba_scratch_size(low)));
+        });
+        group.run([=]() {
+            ScratchScope own;
+            mul_karatsuba(r + 2 * low, a + low, b + low, high, own.allocate(karatsuba_scratch_size(high)));
+        });
+    }
+    else {
+        mul_karatsuba(r, a, b, low, rest);
+        mul_karatsuba(r + 2 * low, a + low, b + low, high, rest);
+    }
+    mul_karatsuba(middle, sum_a, square ? sum_a : sum_b, high + 1, rest);
+    group.wait();
+
+    // middle term = (a0+a1)*(b0+b1) - a0*b0 - a1*b1, then added in at B^h
+    size_t middle_size = 2 * (high + 1);
+    sub(middle, middle, middle_size, r, 2 * low);
+    sub(middle, middle, middle_size, r + 2 * low, 2 * high);
+    while (middle_size > 0 && middle[middle_size - 1] == 0) {
+        middle_size--;
+    }
+    add(r + low, r + low, 2 * n - low, middle, middle_size);
+}
+
+// takes limbs [begin, end) of a number as a BigInt, used to split operands into pieces
+inline BigInt slice(const limb* a, size_t n, size_t begin, size_t end) {
+    BigInt piece;
+    begin = std::min(begin, n);
+    end = std::min(end, n);
+    piece.number.assign(a + begin, a + end);
+    piece.trim();
+    return piece;
+}
+
+// r[0 .. 2n) = a * b for two n-limb operands using Toom-Cook 3-way, r must not overlap a or b:
+// each operand is split into three pieces (a polynomial in B^k), the polynomials are evaluated at
+// 0, 1, -1, -2 and infinity, the five products are multiplied pointwise (recursively), and the
+// product polynomial is interpolated back, replacing nine piece products with five
+inline void mul_toom3(limb* r, const limb* a, const limb* b, size_t n) {
+    bool square = a == b;
+    size_t k = (n + 2) / 3;
+
+    BigInt a0 = slice(a, n, 0, k), a1 = slice(a, n, k, 2 * k), a2 = slice(a, n, 2 * k, n);
+    BigInt b0 = slice(b, n, 0, k), b1 = slice(b, n, k, 2 * k), b2 = slice(b, n, 2 * k, n);
+
+    // evaluation: p(0) = a0, p(1) = a0+a1+a2, p(-1) = a0-a1+a2, p(-2) = a0-2a1+4a2, p(inf) = a2
+    BigInt pt = a0 + a2;
+    BigInt p1 = pt + a1, pm1 = pt - a1;
+    BigInt pm2 = (pm1 + a2 + a2 + pm1) - a0;
+    BigInt qt = b0 + b2;
+    BigInt q1 = qt + b1, qm1 = qt - b1;
+    BigInt qm2 = (qm1 + b2 + b2 + qm1) - b0;
+
+    // pointwise products (squares when multiplying a number by itself), four of them forked in parallel
+    BigInt w0, w1, wm1, wm2, winf;
+    BigInt* products[5] = {&w0, &w1, &wm1, &wm2, &winf};
+    const BigInt* left[5] = {&a0, &p1, &pm1, &pm2, &a2};
+    const BigInt* right[5] = {&b0, &q1, &qm1, &qm2, &b2};
+    TaskGroup group;
+    bool parallel = parallel_active(n);
+    for (size_t i = 0; i < 5; i++) {
+        auto product = [&, i]() {
+            *products[i] = square ? *left[i] * *left[i] : *left[i] * *right[i];
+        };
+        if (parallel && i < 4) {
+            group.run(product);
+        }
+        else {
+            product();
+        }
+    }
+    group.wait();
+
+    // interpolation (Bodrato's sequence), every division here is exact
+    BigInt r0 = w0;
+    BigInt r4 = winf;
+    BigInt r3 = wm2 - w1;
+    divexact_1(r3.number.data(), r3.number.data(), r3.size(), 3);
+    r3.trim();
+    BigInt r1 = w1 - wm1;
+    rshift(r1.number.data(), r1.number.data(), r1.size(), 1);
+    r1.trim();
+    BigInt r2 = wm1 - w0;
+    r3 = r2 - r3;
+    rshift(r3.number.data(), r3.number.data(), r3.size(), 1);
+    r3.trim();
+    r3 += winf;
+    r3 += winf;
+    r2 = r2 + r1 - r4;
+    r1 = r1 - r3;
+
+    // recomposition: r = r0 + r1*B^k + r2*B^2k + r3*B^3k + r4*B^4k, every coefficient is now non-negative
+    for (size_t i = 0; i < 2 * n; i++) {
+        r[i] = 0;
+    }
+    const BigInt* coefficients[5] = {&r0, &r1, &r2, &r3, &r4};
+    for (size_t i = 0; i < 5; i++) {
+        const BigInt& coefficient = *coefficients[i];
+        if (coefficient.size() > 0) {
+            add(r + i * k, r + i * k, 2 * n - i * k, coefficient.number.data(), coefficient.size());
+        }
+    }
+}
+
+// number-theoretic transform primes: each is c*2^k + 1 with primitive root 3, so it has 2^k-th roots of unity
+const uint32_t ntt_prime_0 = 998244353;  // 119*2^23 + 1
+const uint32_t ntt_prime_1 = 167772161;  // 5*2^25 + 1
+const uint32_t ntt_prime_2 = 469762049;  // 7*2^26 + 1
+const uint32_t ntt_root = 3;
+const size_t ntt_max_length = (size_t)1 << 23;  // the longest transform all three primes support
+const size_t ntt_parallel_grain = (size_t)1 << 14;  // the fewest butterflies worth forking as one task
+const int ntt_chunk_bits = 30;  // limbs are cut into 30-bit chunks: 2^22 products of two chunks stay below p0*p1*p2 (~2^86)
+
+// base^exponent mod P (P is a template parameter so the compiler can turn every % into a multiply)
+template <uint32_t P>
+inline uint32_t ntt_pow(uint64_t base, uint64_t exponent) {
+    uint64_t result = 1;
+    base %= P;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result = result * base % P;
+        }
+        base = base * base % P;
+        exponent >>= 1;
+    }
+    return (uint32_t)result;
+}
+
+// -1/P mod 2^32 by Newton's iteration, each step doubles the number of correct low bits
+constexpr uint32_t montgomery_inverse(uint32_t p) {
+    uint32_t x = p;
+    for (int i = 0; i < 5; i++) {
+        x *= 2 - p * x;
+    }
+    return (uint32_t)0 - x;
+}
+
+// Montgomery multiplication mod a 32-bit prime P: montgomery_mul(a, b) = a * b / 2^32 mod P, with no division
+template <uint32_t P>
+inline uint32_t montgomery_mul(uint32_t a, uint32_t b) {
+    constexpr uint32_t p_inverse = montgomery_inverse(P);
+    uint64_t product = (uint64_t)a * b;
+    uint32_t m = (uint32_t)product * p_inverse;
+    uint32_t t = (uint32_t)((product + (uint64_t)m * P) >> 32);
+    return t >= P ? t - P : t;
+}
+
+// in-place iterative (Cooley-Tukey) transform of a power-of-two length vector mod P, or its inverse;
+// the twiddle factors are kept in Montgomery form (w * 2^32), so multiplying by one leaves plain values plain.
+// The inverse transform multiplies by scale/n instead of 1/n, to fold in a correction for the caller
+template <uint32_t P>
+inline void ntt(std::vector<uint32_t>& a, bool inverse, uint32_t scale = 1) {
+    size_t n = a.size();
+    bool parallel = parallel_active(n / 2);  // about as many limbs as the transform has 30-bit chunks over 2
+    const uint32_t r_mod_p = (uint32_t)(((uint64_t)1 << 32) % P);  // 1 in Montgomery form
+
+    // bit-reversal permutation
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+
+    // butterflies, with the twiddle factors of each level precomputed once
+    std::vector<uint32_t> twiddles(n / 2 + 1);
+    for (size_t length = 2; length <= n; length <<= 1) {
+        uint64_t step = ntt_pow<P>(ntt_root, (P - 1) / length);
+        if (inverse) {
+            step = ntt_pow<P>(step, P - 2);
+        }
+        uint32_t step_montgomery = (uint32_t)((step << 32) % P);
+        size_t half = length / 2;
+        twiddles[0] = r_mod_p;
+        for (size_t k = 1; k < half; k++) {
+            twiddles[k] = montgomery_mul<P>(twiddles[k - 1], step_montgomery);
+        }
+
+        // butterflies [begin, end) of this level, numbered block by block
+        auto butterflies = [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ) {
+                uint32_t* low = a.data() + t / half * length;
+                uint32_t* high = low + half;
+                size_t k = t % half, stop = std::min(half, k + (end - t));
+                t += stop - k;
+                for (; k < stop; k++) {
+                    uint32_t u = low[k];
+                    uint32_t v = montgomery_mul<P>(high[k], twiddles[k]);
+                    low[k] = u + v >= P ? u + v - P : u + v;
+                    high[k] = u >= v ? u - v : u + P - v;
+                }
+            }
+        };
+        if (parallel) {
+            parallel_for(n / 2, ntt_parallel_grain, butterflies);
+        }
+        else {
+            butterflies(0, n / 2);
+        }
+    }
+
+    // the inverse transform also divides by n
+    if (inverse) {
+        uint64_t factor = (uint64_t)ntt_pow<P>(n, P - 2) * scale % P;
+        uint32_t factor_montgomery = (uint32_t)((factor << 32) % P);
+        auto scale_range = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                a[i] = montgomery_mul<P>(a[i], factor_montgomery);
+            }
+        };
+        if (parallel) {
+            parallel_for(n, ntt_parallel_grain, scale_range);
+        }
+        else {
+            scale_range(0, n);
+        }
+    }
+}
+
+// the number of 30-bit chunks in an n-limb number
+inline size_t ntt_chunk_count(size_t n) {
+    return (n * limb_bits + ntt_chunk_bits - 1) / ntt_chunk_bits;
+}
+
+// splits a number into 30-bit chunks, zero-padded to length
+inline std::vector<uint32_t> ntt_chunks(const limb* a, size_t n, size_t length) {
+    std::vector<uint32_t> chunks(length, 0);
+    const limb mask = ((limb)1 << ntt_chunk_bits) - 1;
+    for (size_t i = 0, count = ntt_chunk_count(n); i < count; i++) {
+        size_t bit = i * ntt_chunk_bits;
+        size_t index = bit / limb_bits;
+        unsigned int offset = bit % limb_bits;
+        limb value = a[index] >> offset;
+        if (offset + ntt_chunk_bits > limb_bits && index + 1 < n) {
+            value |= a[index + 1] << (limb_bits - offset);
+        }
+        chunks[i] = (uint32_t)(value & mask);
+    }
+    return chunks;
+}
+
+// the cyclic convolution of a and b's chunks mod P (squares a when b is null)
+template <uint32_t P>
+inline std::vector<uint32_t> ntt_convolve(const limb* a, size_t an, const limb* b, size_t bn, size_t length) {
+    // the pointwise Montgomery products come out divided by 2^32, the inverse transform multiplies it back in
+    std::vector<uint32_t> fa = ntt_chunks(a, an, length);
+    ntt<P>(fa, false);
+    if (b == nullptr) {
+        for (size_t i = 0; i < length; i++) {
+            fa[i] = montgomery_mul<P>(fa[i], fa[i]);
+        }
+    }
+    else {
+        std::vector<uint32_t> fb = ntt_chunks(b, bn, length);
+        ntt<P>(fb, false);
+        for (size_t i = 0; i < length; i++) {
+            fa[i] = montgomery_mul<P>(fa[i], fb[i]);
+        }
+    }
+    ntt<P>(fa, true, (uint32_t)(((uint64_t)1 << 32) % P));
+    return fa;
+}
+
+// r[0 .. an+bn) = a * b through three number-theoretic transforms whose results are recombined
+// exactly with the Chinese remainder theorem, r must not overlap a or b; returns false (and leaves r
+// untouched) when the product is too long for the primes' transform length
+inline bool mul_ntt(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    size_t length = 1;
+    while (length < ntt_chunk_count(an) + ntt_chunk_count(bn)) {
+        length <<= 1;
+    }
+    if (length > ntt_max_length) {
+        return false;
+    }
+
+    // the three primes' convolutions are independent, forked in parallel
+    const limb* second = (a == b && an == bn) ? nullptr : b;
+    std::vector<uint32_t> r0, r1, r2;
+    TaskGroup group;
+    if (parallel_active(bn)) {
+        group.run([&]() { r1 = ntt_convolve<ntt_prime_1>(a, an, second, bn, length); });
+        group.run([&]() { r2 = ntt_convolve<ntt_prime_2>(a, an, second, bn, length); });
+    }
+    else {
+        r1 = ntt_convolve<ntt_prime_1>(a, an, second, bn, length);
+        r2 = ntt_convolve<ntt_prime_2>(a, an, second, bn, length);
+    }
+    r0 = ntt_convolve<ntt_prime_0>(a, an, second, bn, length);
+    group.wait();
+
+    // Garner's algorithm: x = v0 + v1*p0 + v2*p0*p1, then the 30-bit columns are carried into limbs
+    const uint64_t p0 = ntt_prime_0, p1 = ntt_prime_1, p2 = ntt_prime_2;
+    const uint64_t p0_inverse_mod_p1 = ntt_pow<ntt_prime_1>(p0, p1 - 2);
+    const uint64_t p0p1_inverse_mod_p2 = ntt_pow<ntt_prime_2>(p0 * p1 % p2, p2 - 2);
+
+    for (size_t i = 0; i < an + bn; i++) {
+        r[i] = 0;
+    }
+    dlimb carry = 0;
+    const limb mask = ((limb)1 << ntt_chunk_bits) - 1;
+    for (size_t i = 0, bit = 0; bit < (an + bn) * limb_bits; i++, bit += ntt_chunk_bits) {
+        if (i < length) {
+            uint64_t v0 = r0[i];
+            uint64_t v1 = (r1[i] + p1 - v0 % p1) % p1 * p0_inverse_mod_p1 % p1;
+            uint64_t v2 = (r2[i] + p2 - (v0 + v1 * p0) % p2) % p2 * p0p1_inverse_mod_p2 % p2;
+            carry += v0 + (dlimb)v1 * p0 + (dlimb)v2 * (p0 * p1);
+        }
+        limb column = (limb)carry & mask;
+        carry >>= ntt_chunk_bits;
+
+        size_t index = bit / limb_bits;
+        unsigned int offset = bit % limb_bits;
+        r[index] |= column << offset;
+        if (offset + ntt_chunk_bits > limb_bits && index + 1 < an + bn) {
+            r[index + 1] |= column >> (limb_bits - offset);
+        }
+    }
+    return true;
+}
+
+// r[0 .. an+bn) = a * b for an >= bn > 0, r must not overlap a or b:
+// picks schoolbook, Karatsuba, Toom-3 or the NTT by operand size, cutting unbalanced operands into bn-limb blocks
+inline void mul(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+    // small operands: the elementary algorithm has the lowest overhead
+    if (bn < BigInt::karatsuba_threshold) {
+        if (a == b && an == bn) {
+            sqr_basecase(r, a, an);
+        }
+        else {
+            mul_basecase(r, a, an, b, bn);
+        }
+        return;
+    }
+
+    // huge operands: a transform handles any shape at near-linear cost
+    if (bn >= BigInt::ntt_threshold && mul_ntt(r, a, an, b, bn)) {
+        return;
+    }
+
+    // balanced operands: divide and conquer
+    if (an == bn) {
+        if (an >= BigInt::toom3_threshold) {
+            mul_toom3(r, a, b, an);
+        }
+        else {
+            ScratchScope scratch;
+            mul_karatsuba(r, a, b, an, scratch.allocate(karatsuba_scratch_size(an)));
+        }
+        return;
+    }
+
+    // unbalanced operands: multiply b by each bn-limb block of a and accumulate the rows (in parallel, every
+    // row is computed first, then they are added up in order)
+    ScratchScope scratch;
+    if (parallel_active(an) && an >= 2 * bn) {
+        size_t blocks = (an + bn - 1) / bn;
+        limb* rows = scratch.allocate(blocks * 2 * bn);
+        parallel_for(blocks, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                size_t offset = i * bn, block = std::min(bn, an - offset);
+                if (block == bn) {
+                    mul(rows + 2 * i * bn, a + offset, bn, b, bn);
+                }
+                else {
+                    mul(rows + 2 * i * bn, b, bn, a + offset, block);
+                }
+            }
+        });
+        for (size_t i = 0; i < an + bn; i++) {
+            r[i] = 0;
+        }
+        for (size_t i = 0; i < blocks; i++) {
+            size_t offset = i * bn, block = std::min(bn, an - offset);
+            add(r + offset, r + offset, an + bn - offset, rows + 2 * i * bn, block + bn);
+        }
+        return;
+    }
+    limb* row = scratch.allocate(2 * bn);
+    for (size_t i = 0; i < an + bn; i++) {
+        r[i] = 0;
+    }
+    for (size_t offset = 0; offset < an; offset += bn) {
+        size_t block = std::min(bn, an - offset);
+        if (block == bn) {
+            mul(row, a + offset, bn, b, bn);
+        }
+        else {
+            mul(row, b, bn, a + offset, block);
+        }
+        add(r + offset, r + offset, an + bn - offset, row, block + bn);
+    }
+}
+
+}  // namespace bigint_detail
+
+
+// ////////// Division Engine ////////// //
+
+// the crossover point is tunable: set BigInt::burnikel_ziegler_threshold before dividing
+inline unsigned int BigInt::burnikel_ziegler_threshold = 80;
+
+namespace bigint_detail {
+
+// a one-limb BigInt
+inline BigInt from_limb(limb x) {
+    BigInt result;
+    if (x != 0) {
+        result.number.push_back(x);
+    }
+    return result;
+}
+
+// x * B^shift (B = 2^64), shifting whole limbs
+inline BigInt shift_limbs(BigInt x, size_t shift) {
+    if (x.size() > 0) {
+        x.number.insert(x.number.begin(), shift, 0);
+    }
+    return x;
+}
+
+// x * 2^shift for a non-negative x
+inline BigInt shift_left_bits(BigInt x, size_t shift) {
+    x = shift_limbs(x, shift / limb_bits);
+    unsigned int bits = shift % limb_bits;
+    if (bits != 0 && x.size() > 0) {
+        limb carry = lshift(x.number.data(), x.number.data(), x.size(), bits);
+        if (carry != 0) {
+            x.number.push_back(carry);
+        }
+    }
+    return x;
+}
+
+// number of trailing zero bits of a non-zero x
+inline size_t trailing_zeros(const BigInt& x) {
+    size_t index = 0;
+    while (x.number[index] == 0) {
+        index++;
+    }
+    return index * limb_bits + __builtin_ctzll(x.number[index]);
+}
+
+// x / 2^shift in place, for a non-negative x
+inline void shift_right_in_place(BigInt& x, size_t shift) {
+    size_t limbs = std::min<size_t>(shift / limb_bits, x.size());
+    x.number.erase(x.number.begin(), x.number.begin() + limbs);
+    if (shift % limb_bits != 0 && x.size() > 0) {
+        rshift(x.number.data(), x.number.data(), x.size(), shift % limb_bits);
+    }
+    x.trim();
+}
+
+// x / 2^shift (rounded down) for a non-negative x
+inline BigInt shift_right_bits(const BigInt& x, size_t shift) {
+    size_t limbs = shift / limb_bits;
+    BigInt result;
+    if (limbs >= x.size()) {
+        return result;
+    }
+    result.number.assign(x.number.begin() + limbs, x.number.end());
+    unsigned int bits = shift % limb_bits;
+    if (bits != 0) {
+        rshift(result.number.data(), result.number.data(), result.size(), bits);
+    }
+    result.trim();
+    return result;
+}
+
+// high * B^shift + low for low < B^shift
+inline BigInt join_limbs(const BigInt& high, const BigInt& low, size_t shift) {
+    BigInt result = shift_limbs(high, shift);
+    if (result.size() == 0) {
+        return low;
+    }
+    std::copy(low.number.begin(), low.number.end(), result.number.begin());
+    return result;
+}
+
+// quotient and remainder of two non-negative BigInts with the schoolbook kernels
+inline void divmod_basecase(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r) {
+    if (cmp(a.number.data(), a.size(), b.number.data(), b.size()) < 0) {
+        q = BigInt();
+        r = a;
+        return;
+    }
+    LimbVector quotient(a.size() - b.size() + 1), remainder(b.size());
+    if (b.size() == 1) {
+        remainder.at(0) = divrem_1(quotient.data(), a.number.data(), a.size(), b.number.at(0));
+    }
+    else {
+        divrem_knuth(quotient.data(), remainder.data(), a.number.data(), a.size(), b.number.data(), b.size());
+    }
+    q.number.swap(quotient);
+    q.negative = false;
+    q.trim();
+    r.number.swap(remainder);
+    r.negative = false;
+    r.trim();
+}
+
+inline void divide_3n2n(const BigInt&, const BigInt&, const BigInt&, const BigInt&, const BigInt&, size_t, BigInt&, BigInt&);
+
+// Burnikel-Ziegler: divides a < b * B^n by an n-limb b whose top bit is set, with two recursive
+// 3n/2n divisions on halves; the work is dominated by multiplications, so it inherits their speed
+inline void divide_2n1n(BigInt a, BigInt b, size_t n, BigInt& q, BigInt& r) {
+    if (n < BigInt::burnikel_ziegler_threshold) {
+        divmod_basecase(a, b, q, r);
+        return;
+    }
+
+    // an odd size is padded with a low zero limb, so both operands split evenly
+    bool pad = n % 2 == 1;
+    if (pad) {
+        a = shift_limbs(a, 1);
+        b = shift_limbs(b, 1);
+        n++;
+    }
+
+    size_t half = n / 2;
+    BigInt b1 = slice(b.number.data(), b.size(), half, n);
+    BigInt b2 = slice(b.number.data(), b.size(), 0, half);
+
+    BigInt q1, q2, remainder;
+    divide_3n2n(slice(a.number.data(), a.size(), n, a.size()), slice(a.number.data(), a.size(), half, n), b, b1, b2, half, q1, remainder);
+    divide_3n2n(remainder, slice(a.number.data(), a.size(), 0, half), b, b1, b2, half, q2, r);
+
+    if (pad && r.size() > 0) {
+        r.number.erase(r.number.begin());
+    }
+    q = join_limbs(q1, q2, half);
+}
+
+// divides a12 * B^n + a3 by b = b1 * B^n + b2 (2n limbs, top bit set), for a12 < b * B^n:
+// estimates the quotient from a12 / b1, which is never too small and at most two too large
+inline void divide_3n2n(const BigInt& a12, const BigInt& a3, const BigInt& b, const BigInt& b1, const BigInt& b2, size_t n, BigInt& q, BigInt& r) {
+    BigInt a1 = slice(a12.number.data(), a12.size(), n, a12.size());
+    if (a1 == b1) {
+        // the estimate would overflow n limbs, so it's B^n - 1
+        q.number.assign(n, ~(limb)0);
+        q.negative = false;
+        r = a12 - shift_limbs(b1, n) + b1;
+    }
+    else {
+        divide_2n1n(a12, b1, n, q, r);
+    }
+
+    r = join_limbs(r, a3, n) - q * b2;
+    while (r.negative) {
+        q -= 1;
+        r += b;
+    }
+}
+
+// q = a / b and r = a % b for non-negative a and b with at least two limbs, by splitting a into
+// n-limb blocks (n = b's size) and running the 2n/1n division across them from the top down
+inline void divmod_burnikel_ziegler(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r) {
+    // normalizes b so its top bit is set
+    unsigned int shift = __builtin_clzll(b.number.back());
+    BigInt divisor = b, dividend = a;
+    if (shift != 0) {
+        lshift(divisor.number.data(), b.number.data(), b.size(), shift);
+        limb out = lshift(dividend.number.data(), a.number.data(), a.size(), shift);
+        if (out != 0) {
+            dividend.number.push_back(out);
+        }
+    }
+
+    size_t n = divisor.size();
+    size_t blocks = (dividend.size() + n - 1) / n;
+    BigInt remainder = slice(dividend.number.data(), dividend.size(), (blocks - 1) * n, blocks * n);
+    q = BigInt();
+    if (remainder >= divisor) {
+        blocks++;  // the top block must be below the divisor, so start from an extra (empty) block
+        remainder = BigInt();
+    }
+
+    for (size_t i = blocks - 1; i-- > 0; ) {
+        BigInt block = slice(dividend.number.data(), dividend.size(), i * n, (i + 1) * n);
+        BigInt digit;
+        divide_2n1n(join_limbs(remainder, block, n), divisor, n, digit, remainder);
+        q = join_limbs(q, digit, n);
+    }
+
+    // undoes the normalization shift on the remainder
+    if (shift != 0 && remainder.size() > 0) {
+        rshift(remainder.number.data(), remainder.number.data(), remainder.size(), shift);
+        remainder.trim();
+    }
+    r = remainder;
+}
+
+// q = |a| / |b| and r = |a| % |b|, picking the single limb, schoolbook or recursive algorithm by size
+inline void divmod_magnitude(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r) {
+    if (b.size() >= BigInt::burnikel_ziegler_threshold && a.size() >= b.size() + BigInt::burnikel_ziegler_threshold / 2) {
+        BigInt dividend = a, divisor = b;
+        dividend.negative = divisor.negative = false;
+        divmod_burnikel_ziegler(dividend, divisor, q, r);
+    }
+    else {
+        divmod_basecase(a, b, q, r);
+    }
+}
+
+}  // namespace bigint_detail
+
+
+// ////////// Arithmetic Operators ////////// //
+
+// signed addition: adds or subtracts the magnitudes depending on the signs
+inline BigInt& BigInt::add_signed(const BigInt& rhs, bool rhs_negative) {
+    // uses the addition algorithm you learned in elementary school, in base 2^64 instead of base 10:
+    //    {12, 3}  (top bar, least significant limb first)
+    //   +{ 5, 1}  (bottom bar)
+    //   --------
+    //    {17, 4}  (sum bar)
+
+    // a += a works in place too: the kernels read each limb before writing it, and a -= a is an equal-size subtraction
+    size_t lhs_size = size();
+    size_t rhs_size = rhs.size();
+
+    // same signs: add the magnitudes, the sign stays the same
+    if (negative == rhs_negative) {
+        size_t max = std::max(lhs_size, rhs_size);
+        number.resize(max + 1, 0);
+        if (lhs_size >= rhs_size) {
+            number.at(max) = bigint_detail::add(number.data(), number.data(), lhs_size, rhs.number.data(), rhs_size);
+        }
+        else {
+            number.at(max) = bigint_detail::add(number.data(), rhs.number.data(), rhs_size, number.data(), lhs_size);
+        }
+    }
+
+    // opposite signs: subtract the smaller magnitude from the larger one, the larger one's sign wins
+    else {
+        if (bigint_detail::cmp(number.data(), lhs_size, rhs.number.data(), rhs_size) >= 0) {
+            bigint_detail::sub(number.data(), number.data(), lhs_size, rhs.number.data(), rhs_size);
+        }
+        else {
+            number.resize(rhs_size, 0);
+            bigint_detail::sub(number.data(), rhs.number.data(), rhs_size, number.data(), lhs_size);
+            negative = rhs_negative;
+        }
+    }
+
+    trim();
+    return *this;
+}
+
+// adds a single-limb magnitude with the given sign in place: one pass that stops early once the carry
+// or borrow dies out
+inline BigInt& BigInt::add_signed(limb rhs, bool rhs_negative) {
+    if (rhs == 0) {
+        return *this;
+    }
+    if (size() == 0) {
+        number.push_back(rhs);
+        negative = rhs_negative;
+        return *this;
+    }
+
+    // same signs: add to the magnitude
+    if (negative == rhs_negative) {
+        limb carry = bigint_detail::add_1(number.data(), number.data(), size(), rhs);
+        if (carry != 0) {
+            number.push_back(carry);
+        }
+        return *this;
+    }
+
+    // opposite signs: subtract the smaller magnitude from the larger one
+    if (size() > 1 || number[0] >= rhs) {
+        bigint_detail::sub(number.data(), number.data(), size(), &rhs, 1);
+        trim();
+    }
+    else {
+        number[0] = rhs - number[0];
+        negative = rhs_negative;
+    }
+    return *this;
+}
+
+// addition using the elementary algorithm
+inline BigInt& BigInt::operator+=(const BigInt& rhs) {
+    return add_signed(rhs, rhs.negative);
+}
+
+inline BigInt operator+(BigInt lhs, const BigInt& rhs) {
+    lhs += rhs;
+    return lhs;
+}
+
+inline BigInt operator+(const BigInt& lhs, BigInt&& rhs) {
+    rhs += lhs;
+    return std::move(rhs);
+}
+
+
+// subtraction using the elementary "borrow" algorithm: a - b is a + (-b)
+inline BigInt& BigInt::operator-=(const BigInt& rhs) {
+    return add_signed(rhs, !rhs.negative);
+}
+
+inline BigInt operator-(BigInt lhs, const BigInt& rhs) {
+    lhs -= rhs;
+    return lhs;
+}
+
+// a - b computed in b's buffer as -b + a
+inline BigInt operator-(const BigInt& lhs, BigInt&& rhs) {
+    rhs.negative = !rhs.negative && rhs.size() > 0;
+    rhs += lhs;
+    return std::move(rhs);
+}
+
+
+// multiplication, dispatching on the operand sizes
+inline BigInt& BigInt::operator*=(const BigInt& rhs) {
+    // small operands use the multiplication algorithm you learned in elementary school, one limb at a time;
+    // larger ones switch to Karatsuba and then Toom-3 (see the Multiplication Engine above)
+
+    // edge case: anything times zero is zero
+    if (size() == 0 || rhs.size() == 0) {
+        number.clear();
+        negative = false;
+        return *this;
+    }
+
+    bigint_detail::LimbVector result(size() + rhs.size());
+    if (size() >= rhs.size()) {
+        bigint_detail::mul(result.data(), number.data(), size(), rhs.number.data(), rhs.size());
+    }
+    else {
+        bigint_detail::mul(result.data(), rhs.number.data(), rhs.size(), number.data(), size());
+    }
+
+    number.swap(result);  // sets the result number into this number
+    negative = negative != rhs.negative;
+    trim();
+    return *this;
+}
+
+inline BigInt operator*(BigInt lhs, const BigInt& rhs) {
+    lhs *= rhs;
+    return lhs;
+}
+
+inline BigInt operator*(const BigInt& lhs, BigInt&& rhs) {
+    rhs *= lhs;
+    return std::move(rhs);
+}
+
+using namespace std;
+
+
+// quotient and remainder in one pass, written into caller-provided outputs (which may alias a or b):
+// the quotient truncates towards zero and the remainder takes the dividend's sign, so a == q * b + r
+inline void divmod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder) {
+    // uses the long division algorithm to compute the division:
+    //    _102_
+    // 13|1326
+
+    // edge case: dividing by zero
+    if (b.size() == 0) {
+        throw std::domain_error("BigInt: division by zero");
+    }
+
+    bool quotient_negative = a.negative != b.negative;
+    bool remainder_negative = a.negative;
+
+    BigInt q, r;
+    bigint_detail::divmod_magnitude(a, b, q, r);
+    q.negative = quotient_negative;
+    q.trim();
+    r.negative = remainder_negative;
+    r.trim();
+
+    quotient.swap(q);
+    remainder.swap(r);
+}
+
+// quotient and remainder in one pass, returned as {quotient, remainder}
+inline std::pair<BigInt, BigInt> divmod(const BigInt& a, const BigInt& b) {
+    std::pair<BigInt, BigInt> result;
+    divmod(a, b, result.first, result.second);
+    return result;
+}
+
+// a * b under the given execution policy, whatever BigInt::execution_policy says
+inline BigInt multiply(ExecutionPolicy policy, const BigInt& a, const BigInt& b) {
+    ExecutionScope scope(policy);
+    return a * b;
+}
+
+// divmod under the given execution policy (in parallel, the multiplications of recursive division split across threads)
+inline std::pair<BigInt, BigInt> divmod(ExecutionPolicy policy, const BigInt& a, const BigInt& b) {
+    ExecutionScope scope(policy);
+    return divmod(a, b);
+}
+
+// division using the long division algorithm, truncating towards zero
+inline BigInt& BigInt::operator/=(const BigInt& rhs) {
+    BigInt remainder;
+    divmod(*this, rhs, *this, remainder);
+    return *this;
+}
+
+inline BigInt operator/(BigInt lhs, const BigInt& rhs) {
+    lhs /= rhs;
+    return lhs;
+}
+
+// modulo using the remainder of the same long division (takes the sign of the left side)
+inline BigInt& BigInt::operator%=(const BigInt& rhs) {
+    BigInt quotient;
+    divmod(*this, rhs, quotient, *this);
+    return *this;
+}
+
+inline BigInt operator%(BigInt lhs, const BigInt& rhs) {
+    lhs %= rhs;
+    return lhs;
+}
+
+
+// ////////// Radix Conversion ////////// //
+
+// the crossover point is tunable: set BigInt::decimal_conversion_threshold before converting
+inline unsigned int BigInt::decimal_conversion_threshold = 40;
+
+namespace bigint_detail {
+
+// 10^(19 * 2^level), squared up from 10^19 and cached per thread, so the tree is built once for the largest
+// number converted and shared by every later conversion
+inline const BigInt& decimal_power(size_t level) {
+    thread_local std::vector<BigInt> powers;
+    if (powers.empty()) {
+        powers.push_back(from_limb(decimal_base));
+    }
+    while (powers.size() <= level) {
+        powers.push_back(powers.back() * powers.back());
+    }
+    return powers[level];
+}
+
+// writes the digits of a non-negative x < 10^(19 * 2^level) from 'out' on, and returns the end of the digits.
+// With padding x fills exactly 19 * 2^level digits (leading zeros included), without it zero writes nothing.
+// Large numbers split at the middle power: x = high * 10^(19 * 2^(level - 1)) + low, so the halves are
+// converted independently with one fast division per node instead of a divrem_1 pass per 19 digits
+inline char* write_decimal(const BigInt& x, size_t level, char* out, bool pad) {
+    if (level > 0 && x.size() >= BigInt::decimal_conversion_threshold) {
+        const BigInt& half = decimal_power(level - 1);
+        if (!pad && x < half) {
+            return write_decimal(x, level - 1, out, false);
+        }
+        BigInt high, low;
+        divmod_magnitude(x, half, high, low);
+        out = write_decimal(high, level - 1, out, pad);
+        return write_decimal(low, level - 1, out, true);
+    }
+
+    // base case: peel off 19 digits at a time by dividing by 10^19, least significant chunk first
+    LimbVector temp = x.number;
+    std::vector<limb> chunks;
+    size_t temp_size = temp.size();
+    while (temp_size > 0) {
+        chunks.push_back(divrem_1(temp.data(), temp.data(), temp_size, decimal_base));
+        while (temp_size > 0 && temp[temp_size - 1] == 0) {
+            temp_size--;
+        }
+    }
+
+    // every chunk but the top one is padded with zeros to 19 digits, and the whole field to 19 * 2^level
+    size_t digits = chunks.empty() ? 0 : (chunks.size() - 1) * decimal_base_digits + std::to_string(chunks.back()).size();
+    char* end = out + (pad ? decimal_base_digits << level : digits);
+    char* position = end;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        limb chunk = chunks[i];
+        for (int d = 0; d < decimal_base_digits && (chunk != 0 || i + 1 < chunks.size()); d++) {
+            *--position = '0' + chunk % 10;
+            chunk /= 10;
+        }
+    }
+    while (position > out) {
+        *--position = '0';
+    }
+    return end;
+}
+
+// the value of n decimal digits (already validated). Long inputs split so the low part is 19 * 2^k digits:
+// value = high * 10^(19 * 2^k) + low, with the halves parsed recursively and joined by one fast multiplication
+inline BigInt parse_decimal(const char* digits, size_t n) {
+    if (n >= (size_t)2 * BigInt::decimal_conversion_threshold * decimal_base_digits) {
+        size_t level = 0;
+        while (((size_t)decimal_base_digits << (level + 1)) < n) {
+            level++;
+        }
+        size_t low_length = (size_t)decimal_base_digits << level;
+        BigInt result = parse_decimal(digits, n - low_length) * decimal_power(level);
+        result += parse_decimal(digits + n - low_length, low_length);
+        return result;
+    }
+
+    // base case: consume up to 19 digits at a time: number = number * 10^(chunk length) + chunk
+    BigInt result;
+    size_t position = 0;
+    size_t chunk_length = n % decimal_base_digits;
+    if (chunk_length == 0) {
+        chunk_length = decimal_base_digits;
+    }
+    while (position < n) {
+        limb chunk = 0;
+        limb scale = 1;
+        for (size_t i = position; i < position + chunk_length; i++) {
+            chunk = chunk * 10 + (digits[i] - '0');
+            scale *= 10;
+        }
+
+        limb carry = mul_1(result.number.data(), result.number.data(), result.size(), scale);
+        carry += add_1(result.number.data(), result.number.data(), result.size(), chunk);  // can't overflow, the product's carry is below scale
+        if (carry != 0) {
+            result.number.push_back(carry);
+        }
+
+        position += chunk_length;
+        chunk_length = decimal_base_digits;
+    }
+    result.trim();
+    return result;
+}
+
+}  // namespace bigint_detail
+
+
+// ////////// Initializations ////////// //
+
+// base initialization to empty number ("0")
+inline BigInt::BigInt() {
+}
+
+// initialization to another BigInt
+inline BigInt::BigInt(const BigInt& rhs) {
+    number = rhs.number;
+    negative = rhs.negative;
+}
+
+// initialization from an expiring BigInt, which is left as zero
+inline BigInt::BigInt(BigInt&& rhs) noexcept : number(std::move(rhs.number)), negative(rhs.negative) {
+    rhs.negative = false;
+}
+
+// initialization to a string
+inline BigInt::BigInt(std::string rhs) {
+    initialize(rhs);
+}
+
+// initialization to an int, straight into the inline limb (no string round-trip, no allocation)
+inline BigInt::BigInt(int rhs) {
+    negative = rhs < 0;
+    limb magnitude = rhs < 0 ? 0 - (limb)rhs : (limb)rhs;  // also right for INT_MIN
+    if (magnitude != 0) {
+        number.push_back(magnitude);
+    }
+}
+
+// initialization to any other built-in integer
+template <typename T, typename>
+BigInt::BigInt(T rhs) {
+    initialize_native(rhs);
+}
+
+// sets the limbs from a built-in integer's magnitude, a limb at a time
+template <typename T>
+void BigInt::initialize_native(T rhs) {
+    negative = T(-1) < T(0) && rhs < T(0);
+    bigint_detail::dlimb magnitude = negative ? 0 - (bigint_detail::dlimb)rhs : (bigint_detail::dlimb)rhs;
+    number.clear();
+    while (magnitude != 0) {
+        number.push_back((limb)magnitude);
+        magnitude >>= bigint_detail::limb_bits;
+    }
+}
+
+// initialization to a character/array
+inline BigInt::BigInt(const char* rhs) {
+    initialize(std::string(rhs));
+}
+
+// initialization to zero with limbs from a given memory resource (which must outlive this BigInt)
+inline BigInt::BigInt(std::pmr::memory_resource* resource) : number(resource) {
+}
+
+// the resource this BigInt's heap limbs come from (the built-in pool unless set otherwise)
+inline std::pmr::memory_resource* BigInt::memory_resource() const {
+    return number.resource();
+}
+
+// every BigInt created afterwards on the calling thread allocates from this resource; nullptr restores the pool
+inline void BigInt::set_memory_resource(std::pmr::memory_resource* resource) {
+    bigint_detail::thread_limb_resource = resource == bigint_detail::LimbPool::instance() ? nullptr : resource;
+}
+
+// catchall initialization function: takes a decimal string (optionally signed), converts it into limbs
+inline void BigInt::initialize(std::string source) {
+    size_t position = 0;
+    bool is_negative = false;
+    if (!source.empty() && (source.at(0) == '-' || source.at(0) == '+')) {
+        is_negative = source.at(0) == '-';
+        position = 1;
+    }
+
+    for (size_t i = position; i < source.size(); i++) {
+        if (source[i] < '0' || source[i] > '9') {
+            throw std::invalid_argument("BigInt: invalid decimal string \"" + source + "\"");
+        }
+    }
+
+    BigInt value = bigint_detail::parse_decimal(source.data() + position, source.size() - position);
+    number.swap(value.number);
+    negative = is_negative;
+    trim();  // edge case: source = "0" (or "-0", "000")
+    return;
+}
+
+
+// ////////// Conversion Functions ////////// //
+
+// converts the number to string form: 12345 to "12345"
+inline std::string BigInt::to_string() const {
+    // edge case: zero
+    if (size() == 0) {
+        return "0";
+    }
+
+    // every 64 bits hold at most 20 decimal digits: size the buffer once, write the digits, then trim it
+    std::string result(negative + size() * 20, '0');
+    char* first = &result[0] + negative;
+    if (negative) {
+        result[0] = '-';
+    }
+
+    BigInt magnitude = *this;
+    magnitude.negative = false;
+    size_t level = 0;
+    if (size() >= decimal_conversion_threshold) {
+        while (bigint_detail::decimal_power(level) <= magnitude) {
+            level++;
+        }
+    }
+    char* last = bigint_detail::write_decimal(magnitude, level, first, false);
+    result.resize(last - &result[0]);
+    return result;
+}
+
+// converts the number to a built-in integer type straight from the limbs
+template <typename T>
+T BigInt::to_native() const {
+    static_assert(bigint_detail::is_native_integer<T>::value, "BigInt::to_native converts to built-in integer types");
+    const bool is_signed = T(-1) < T(0);
+    const bigint_detail::dlimb max = sizeof(T) == 16 ? ~(bigint_detail::dlimb)0 >> is_signed : ((bigint_detail::dlimb)1 << (8 * sizeof(T) - is_signed)) - 1;
+
+    bigint_detail::dlimb magnitude = 0;
+    bool fits = size() <= 2;
+    if (fits) {
+        for (size_t i = size(); i-- > 0; ) {
+            magnitude = (magnitude << bigint_detail::limb_bits) | number[i];
+        }
+        // a negative value may reach one past max (ex: INT_MIN), only in a signed type
+        fits = negative ? is_signed && magnitude - 1 <= max : magnitude <= max;
+    }
+    if (!fits) {
+        throw std::out_of_range("BigInt: " + to_string() + " does not fit in the requested integer type");
+    }
+    return negative ? (T)(0 - magnitude) : (T)magnitude;
+}
+
+// converts the number to an integer
+inline int BigInt::to_int() const {
+    return to_native<int>();
+}
+
+// converts the number to an unsigned integer
+inline unsigned int BigInt::to_uint() const {
+    return to_native<unsigned int>();
+}
+
+// converts the number to a long integer
+inline long int BigInt::to_long_int() const {
+    return to_native<long int>();
+}
+
+// converts the number to a long unsigned integer
+inline long unsigned int BigInt::to_long_uint() const {
+    return to_native<long unsigned int>();
+}
+
+// converts the number to a long long integer
+inline long long int BigInt::to_long_long_int() const {
+    return to_native<long long int>();
+}
+
+// converts the number to a long long unsigned integer
+inline long long unsigned int BigInt::to_long_long_uint() const {
+    return to_native<long long unsigned int>();
+}
+
+// converts the number to a 128-bit integer
+inline __int128 BigInt::to_int128() const {
+    return to_native<__int128>();
+}
+
+// converts the number to a 128-bit unsigned integer
+inline unsigned __int128 BigInt::to_uint128() const {
+    return to_native<unsigned __int128>();
+}
+
+
+// ////////// Binary Conversion ////////// //
+
+// the magnitude as raw bytes (most significant first for ByteOrder::big_endian, least significant first for
+// little_endian), and a framed format for storing or sending many numbers: each number is a LEB128 varint
+// holding (byte length << 1) | sign, followed by that many little-endian magnitude bytes, and a sequence is
+// just frames back to back (ex: 0 is {0x00}, 300 is {0x04, 0x2c, 0x01}, -1 is {0x03, 0x01})
+namespace bigint_detail {
+
+// a limb from 8 little-endian bytes, and back
+inline limb load_little_endian(const uint8_t* in) {
+    limb x;
+    std::memcpy(&x, in, sizeof(limb));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap64(x);
+#endif
+    return x;
+}
+
+inline void store_little_endian(uint8_t* out, limb x) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap64(x);
+#endif
+    std::memcpy(out, &x, sizeof(limb));
+}
+
+// out[0 .. width) = the low width bytes of n limbs, least significant first (zeros past the limbs)
+inline void limbs_to_bytes(uint8_t* out, size_t width, const limb* a, size_t n) {
+    size_t whole = std::min(n, width / sizeof(limb));
+    for (size_t i = 0; i < whole; i++) {
+        store_little_endian(out + i * sizeof(limb), a[i]);
+    }
+    for (size_t j = whole * sizeof(limb); j < width; j++) {
+        size_t i = j / sizeof(limb);
+        out[j] = i < n ? (uint8_t)(a[i] >> (8 * (j % sizeof(limb)))) : 0;
+    }
+}
+
+// r[0 .. (size + 7) / 8) = size bytes, least significant first
+inline void bytes_to_limbs(limb* r, const uint8_t* in, size_t size) {
+    size_t whole = size / sizeof(limb);
+    for (size_t i = 0; i < whole; i++) {
+        r[i] = load_little_endian(in + i * sizeof(limb));
+    }
+    if (size % sizeof(limb) != 0) {
+        limb last = 0;
+        for (size_t j = size; j-- > whole * sizeof(limb); ) {
+            last = (last << 8) | in[j];
+        }
+        r[whole] = last;
+    }
+}
+
+// LEB128: 7 bits per byte, least significant first, the top bit set on every byte but the last
+inline size_t varint_size(uint64_t x) {
+    size_t size = 1;
+    while (x >= 0x80) {
+        x >>= 7;
+        size++;
+    }
+    return size;
+}
+
+inline uint8_t* write_varint(uint8_t* out, uint64_t x) {
+    while (x >= 0x80) {
+        *out++ = (uint8_t)(x | 0x80);
+        x >>= 7;
+    }
+    *out++ = (uint8_t)x;
+    return out;
+}
+
+inline const uint8_t* read_varint(const uint8_t* in, const uint8_t* end, uint64_t& x) {
+    x = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (in == end) {
+            throw std::invalid_argument("BigInt: truncated varint in framed data");
+        }
+        uint8_t byte = *in++;
+        x |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return in;
+        }
+    }
+    throw std::invalid_argument("BigInt: varint longer than 64 bits in framed data");
+}
+
+}  // namespace bigint_detail
+
+// the number of bytes in the magnitude
+inline size_t BigInt::byte_length() const {
+    return (bit_length() + 7) / 8;
+}
+
+// writes the magnitude into exactly width bytes of caller memory, zero-padded
+inline void BigInt::export_bytes(uint8_t* out, size_t width, ByteOrder order) const {
+    if (byte_length() > width) {
+        throw std::out_of_range("BigInt: " + std::to_string(byte_length()) + "-byte magnitude does not fit in " + std::to_string(width) + " bytes");
+    }
+    bigint_detail::limbs_to_bytes(out, width, number.data(), size());
+    if (order == ByteOrder::big_endian) {
+        std::reverse(out, out + width);
+    }
+}
+
+inline std::vector<uint8_t> BigInt::to_bytes(ByteOrder order) const {
+    return to_bytes(byte_length(), order);
+}
+
+inline std::vector<uint8_t> BigInt::to_bytes(size_t width, ByteOrder order) const {
+    std::vector<uint8_t> bytes(width);
+    export_bytes(bytes.data(), width, order);
+    return bytes;
+}
+
+// reads a non-negative magnitude from caller memory, reusing this BigInt's limbs
+inline void BigInt::import_bytes(const uint8_t* in, size_t size, ByteOrder order) {
+    number.resize((size + sizeof(limb) - 1) / sizeof(limb));
+    if (order == ByteOrder::little_endian) {
+        bigint_detail::bytes_to_limbs(number.data(), in, size);
+    }
+    else {
+        // whole limbs from the back, then the leftover most significant bytes
+        size_t whole = size / sizeof(limb);
+        for (size_t i = 0; i < whole; i++) {
+            number[i] = __builtin_bswap64(bigint_detail::load_little_endian(in + size - (i + 1) * sizeof(limb)));
+        }
+        if (size % sizeof(limb) != 0) {
+            limb last = 0;
+            for (size_t j = 0; j < size % sizeof(limb); j++) {
+                last = (last << 8) | in[j];
+            }
+            number[whole] = last;
+        }
+    }
+    negative = false;
+    trim();
+}
+
+inline BigInt BigInt::from_bytes(const uint8_t* in, size_t size, ByteOrder order) {
+    BigInt result;
+    result.import_bytes(in, size, order);
+    return result;
+}
+
+inline BigInt BigInt::from_bytes(const std::vector<uint8_t>& bytes, ByteOrder order) {
+    return from_bytes(bytes.data(), bytes.size(), order);
+}
+
+inline size_t BigInt::framed_size() const {
+    size_t length = byte_length();
+    return bigint_detail::varint_size(((uint64_t)length << 1) | negative) + length;
+}
+
+inline uint8_t* BigInt::write_framed(uint8_t* out) const {
+    size_t length = byte_length();
+    out = bigint_detail::write_varint(out, ((uint64_t)length << 1) | negative);
+    bigint_detail::limbs_to_bytes(out, length, number.data(), size());
+    return out + length;
+}
+
+inline const uint8_t* BigInt::read_framed(const uint8_t* in, const uint8_t* end) {
+    uint64_t header;
+    in = bigint_detail::read_varint(in, end, header);
+    uint64_t length = header >> 1;
+    if (length > (uint64_t)(end - in)) {
+        throw std::invalid_argument("BigInt: framed number runs past the end of the data");
+    }
+    import_bytes(in, length, ByteOrder::little_endian);
+    negative = (header & 1) && size() > 0;
+    return in + length;
+}
+
+inline std::vector<uint8_t> to_framed(const std::vector<BigInt>& values) {
+    size_t total = 0;
+    for (const BigInt& value : values) {
+        total += value.framed_size();
+    }
+    std::vector<uint8_t> bytes(total);
+    uint8_t* out = bytes.data();
+    for (const BigInt& value : values) {
+        out = value.write_framed(out);
+    }
+    return bytes;
+}
+
+inline std::vector<BigInt> from_framed(const uint8_t* in, size_t size) {
+    std::vector<BigInt> values;
+    const uint8_t* end = in + size;
+    while (in != end) {
+        values.emplace_back();
+        in = values.back().read_framed(in, end);
+    }
+    return values;
+}
+
+inline std::vector<BigInt> from_framed(const std::vector<uint8_t>& bytes) {
+    return from_framed(bytes.data(), bytes.size());
+}
+
+
+// ////////// Literals ////////// //
+
+// a BigInt value fixed at compile time: the limbs are parsed by the compiler and stored as constant data,
+// and turning it into a BigInt copies them without parsing (and without allocating, up to four limbs)
+// (ex: static constexpr auto p = 0xffffffff00000001_big; BigInt x = p;)
+template <size_t N>
+struct BigIntConstant {
+    std::array<bigint_detail::limb, N> limbs;  // the magnitude, least significant limb first, without leading zero limbs
+    bool negative;
+
+    constexpr BigIntConstant operator-() const {  // ex: -5_big
+        return {limbs, !negative && N > 0};
+    }
+
+    operator BigInt() const {
+        BigInt result;
+        result.number.assign(limbs.begin(), limbs.end());
+        result.negative = negative;
+        return result;
+    }
+};
+
+namespace bigint_detail {
+
+// the characters of an integer literal, kept as static data so constant expressions can point into them
+template <char... Chars>
+struct LiteralText {
+    static constexpr char text[sizeof...(Chars) + 1] = {Chars..., '\0'};
+};
+
+// the value of a digit character in any base up to 16, or -1
+constexpr int literal_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// parses an integer literal as C++ reads it (0x hex, 0b binary, a leading 0 for octal, ' as a digit
+// separator) into N limbs; a malformed literal throws, which fails compilation in a constant expression
+template <size_t N>
+constexpr std::array<limb, N> parse_literal(const char* text) {
+    limb base = 10;
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text += 2;
+    }
+    else if (text[0] == '0' && (text[1] == 'b' || text[1] == 'B')) {
+        base = 2;
+        text += 2;
+    }
+    else if (text[0] == '0') {
+        base = 8;
+    }
+
+    // digits are gathered into a limb-sized chunk (ex: 19 decimal digits), then the chunk is shifted in
+    std::array<limb, N> result{};
+    limb chunk = 0, scale = 1;
+    for (; *text != '\0'; text++) {
+        if (*text == '\'') {
+            continue;
+        }
+        int digit = literal_digit(*text);
+        if (digit < 0 || (limb)digit >= base) {
+            throw std::invalid_argument("BigInt: _big takes an integer literal");
+        }
+        chunk = chunk * base + digit;
+        scale *= base;
+        if (scale > ~(limb)0 / base) {
+            mul_1(result.data(), result.data(), N, scale);
+            add_1(result.data(), result.data(), N, chunk);
+            chunk = 0;
+            scale = 1;
+        }
+    }
+    mul_1(result.data(), result.data(), N, scale);
+    add_1(result.data(), result.data(), N, chunk);
+    return result;
+}
+
+}  // namespace bigint_detail
+
+// BigInt literals, parsed at compile time (ex: 340282366920938463463374607431768211457_big, 0xffff'ffff_big)
+template <char... Chars>
+constexpr auto operator""_big() {
+    // each digit adds at most four bits, so this many limbs always hold the value
+    constexpr size_t capacity = sizeof...(Chars) * 4 / bigint_detail::limb_bits + 1;
+    constexpr std::array<bigint_detail::limb, capacity> value =
+        bigint_detail::parse_literal<capacity>(bigint_detail::LiteralText<Chars...>::text);
+    constexpr size_t n = bigint_detail::significant_limbs(value.data(), capacity);
+
+    BigIntConstant<n> result{};
+    for (size_t i = 0; i < n; i++) {
+        result.limbs[i] = value[i];
+    }
+    return result;
+}
+
+
+// ////////// Assignment Operators ////////// //
+
+// asignment to another BigInt
+inline BigInt& BigInt::operator=(const BigInt& rhs) {
+    number = rhs.number;  // reuses this number's buffer when it is large enough
+    negative = rhs.negative;
+    return *this;
+}
+
+// move asignment: takes over the limbs of an expiring BigInt, which is left as zero
+inline BigInt& BigInt::operator=(BigInt&& rhs) noexcept {
+    if (this != &rhs) {
+        number = std::move(rhs.number);
+        negative = rhs.negative;
+        rhs.negative = false;
+    }
+    return *this;
+}
+
+// assignment to a char array (BigInt a = "123")
+inline BigInt& BigInt::operator=(const char* rhs) {
+  initialize(std::string(rhs));
+  return *this;
+}
+
+// assignment to an integer (BigInt a = 123)
+inline BigInt& BigInt::operator=(const int& rhs) {
+  BigInt value(rhs);
+  swap(value);
+  return *this;
+}
+
+// asignment to any other built-in integer (reusing the limb buffer)
+template <typename T>
+bigint_detail::if_native_integer<T, BigInt&> BigInt::operator=(T rhs) {
+    initialize_native(rhs);
+    return *this;
+}
+
+// asignment to a string
+inline BigInt& BigInt::operator=(std::string rhs) {
+  initialize(rhs);
+  return *this;
+}
+
+// assignment to a vector of decimal digits
+inline BigInt& BigInt::operator=(std::vector<int> rhs) {
+  std::string digits;
+  for (int i : rhs) {
+      digits += std::to_string(i);
+  }
+  initialize(digits);
+  return *this;
+}
+
+
+// ////////// Stream Operators ////////// //
+
+// outstream (ex: cout << BigInt)
+inline std::ostream& operator<<(std::ostream& os, const BigInt& rhs) {
+    os << rhs.to_string();
+    return os;
+}
+
+// instream (ex: somestream >> BigInt)
+inline std::istream& operator>>(std::istream& is, BigInt& rhs) {
+    std::string input;
+    is >> input;
+    rhs = input;
+    return is;
+}
+
+
+// ////////// Comparisan Operators ////////// //
+
+bool operator==(const BigInt& lhs, const BigInt& rhs) {
+    return lhs.negative == rhs.negative && lhs.number == rhs.number;
+}
+
+bool operator!=(const BigInt& lhs, const BigInt& rhs) {
+    return !(lhs == rhs);
+}
+
+bool operator<(const BigInt& lhs, const BigInt& rhs) {
+    // different signs: the negative one is smaller
+    if (lhs.negative != rhs.negative) {
+        return lhs.negative;
+    }
+
+    // same signs: compare the magnitudes, a larger magnitude is smaller when negative
+    int comparison = bigint_detail::cmp(lhs.number.data(), lhs.size(), rhs.number.data(), rhs.size());
+    if (lhs.negative) {
+        return comparison > 0;
+    }
+    return comparison < 0;
+}
+
+bool operator>(const BigInt& lhs, const BigInt& rhs) {
+    return rhs < lhs;
+}
+
+bool operator>=(const BigInt& lhs, const BigInt& rhs) {
+    return !(lhs < rhs);
+}
+
+bool operator<=(const BigInt& lhs, const BigInt& rhs) {
+    return !(rhs < lhs);
+}
+
+
+// ////////// Prefix/Postfix Operators ////////// //
+
+// somebigint++
+inline BigInt& BigInt::operator++(int blank) {
+    *this += 1;  // in place: no temporary, and the limbs only grow on a carry out of the top
+    return *this;
+}
+
+// ++somebigint
+inline BigInt& BigInt::operator++() {
+    *this += 1;
+    return *this;
+}
+
+// somebigint--
+inline BigInt& BigInt::operator--(int blank) {
+    *this -= 1;
+    return *this;
+}
+
+// --somebigint
+inline BigInt& BigInt::operator--() {
+    *this -= 1;
+    return *this;
+}
+
+
+// ////////// Native Integer Operators ////////// //
+
+// arithmetic and comparisons with a built-in integer operand of up to 64 bits: the integer is used as a
+// single limb directly, so a + 1 or a * 10 is one pass over a's limbs and a == 0 or a % 2 is O(1)
+
+template <typename T>
+bigint_detail::if_limb_integer<T, BigInt&> BigInt::operator+=(T rhs) {
+    bool rhs_negative = false;
+    limb magnitude = bigint_detail::native_magnitude(rhs, rhs_negative);
+    return add_signed(magnitude, rhs_negative);
+}
+
+template <typename T>
+bigint_detail::if_limb_integer<T, BigInt&> BigInt::operator-=(T rhs) {
+    bool rhs_negative = false;
+    limb magnitude = bigint_detail::native_magnitude(rhs, rhs_negative);
+    return add_signed(magnitude, !rhs_negative);
+}
+
+template <typename T>
+bigint_detail::if_limb_integer<T, BigInt&> BigInt::operator*=(T rhs) {
+    bool rhs_negative = false;
+    limb magnitude = bigint_detail::native_magnitude(rhs, rhs_negative);
+    limb carry = bigint_detail::mul_1(number.data(), number.data(), size(), magnitude);
+    if (carry != 0) {
+        number.push_back(carry);
+    }
+    negative = negative != rhs_negative;
+    trim();
+    return *this;
+}
+
+// rounds toward zero like the BigInt division; a power of two is a shift of the magnitude
+template <typename T>
+bigint_detail::if_limb_integer<T, BigInt&> BigInt::operator/=(T rhs) {
+    bool rhs_negative = false;
+    limb magnitude = bigint_detail::native_magnitude(rhs, rhs_negative);
+    if (magnitude == 0) {
+        throw std::domain_error("BigInt: division by zero");
+    }
+    if ((magnitude & (magnitude - 1)) == 0) {
+        unsigned int shift = __builtin_ctzll(magnitude);
+        if (shift != 0) {
+            bigint_detail::rshift(number.data(), number.data(), size(), shift);
+        }
+    }
+    else {
+        bigint_detail::divrem_1(number.data(), number.data(), size(), magnitude);
+    }
+    negative = negative != rhs_negative;
+    trim();
+    return *this;
+}
+
+// the remainder takes the dividend's sign like the BigInt %; a power of two only needs the low limb
+template <typename T>
+bigint_detail::if_limb_integer<T, BigInt&> BigInt::operator%=(T rhs) {
+    bool rhs_negative = false;
+    limb magnitude = bigint_detail::native_magnitude(rhs, rhs_negative);
+    if (magnitude == 0) {
+        throw std::domain_error("BigInt: division by zero");
+    }
+    limb remainder = 0;
+    if (size() != 0) {
+        if ((magnitude & (magnitude - 1)) == 0) {
+            remainder = number[0] & (magnitude - 1);
+        }
+        else {
+            remainder = bigint_detail::mod_1(number.data(), size(), magnitude);
+        }
+    }
+    number.clear();
+    if (remainder != 0) {
+        number.push_back(remainder);
+    }
+    trim();
+    return *this;
+}
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, BigInt> operator+(L lhs, T rhs) {
+    return lhs += rhs;
+}
+
+template <typename T, typename R>
+inline bigint_detail::if_mixed<R, T, BigInt> operator+(T lhs, R rhs) {
+    return rhs += lhs;
+}
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, BigInt> operator-(L lhs, T rhs) {
+    return lhs -= rhs;
+}
+
+// lhs - rhs as -(rhs - lhs)
+template <typename T, typename R>
+inline bigint_detail::if_mixed<R, T, BigInt> operator-(T lhs, R rhs) {
+    rhs -= lhs;
+    rhs.negative = !rhs.negative && rhs.size() != 0;
+    return rhs;
+}
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, BigInt> operator*(L lhs, T rhs) {
+    return lhs *= rhs;
+}
+
+template <typename T, typename R>
+inline bigint_detail::if_mixed<R, T, BigInt> operator*(T lhs, R rhs) {
+    return rhs *= lhs;
+}
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, BigInt> operator/(L lhs, T rhs) {
+    return lhs /= rhs;
+}
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, BigInt> operator%(L lhs, T rhs) {
+    return lhs %= rhs;
+}
+
+namespace bigint_detail {
+
+// compares a BigInt with a built-in integer: returns -1, 0 or 1
+template <typename T>
+inline int compare_native(const BigInt& lhs, T rhs) {
+    bool rhs_negative = false;
+    limb magnitude = native_magnitude(rhs, rhs_negative);
+    if (lhs.negative != rhs_negative) {
+        return lhs.negative ? -1 : 1;
+    }
+    int result = lhs.size() > 1 ? 1 : cmp(lhs.number.data(), lhs.size(), &magnitude, magnitude != 0);
+    return lhs.negative ? -result : result;
+}
+
+}  // namespace bigint_detail
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, bool> operator==(const L& lhs, T rhs) {
+    return bigint_detail::compare_native(lhs, rhs) == 0;
+}
+
+template <typename T, typename R>
+inline bigint_detail::if_mixed<R, T, bool> operator==(T lhs, const R& rhs) {
+    return bigint_detail::compare_native(rhs, lhs) == 0;
+}
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, bool> operator!=(const L& lhs, T rhs) {
+    return bigint_detail::compare_native(lhs, rhs) != 0;
+}
+
+template <typename T, typename R>
+inline bigint_detail::if_mixed<R, T, bool> operator!=(T lhs, const R& rhs) {
+    return bigint_detail::compare_native(rhs, lhs) != 0;
+}
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, bool> operator<(const L& lhs, T rhs) {
+    return bigint_detail::compare_native(lhs, rhs) < 0;
+}
+
+template <typename T, typename R>
+inline bigint_detail::if_mixed<R, T, bool> operator<(T lhs, const R& rhs) {
+    return bigint_detail::compare_native(rhs, lhs) > 0;
+}
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, bool> operator>(const L& lhs, T rhs) {
+    return bigint_detail::compare_native(lhs, rhs) > 0;
+}
+
+template <typename T, typename R>
+inline bigint_detail::if_mixed<R, T, bool> operator>(T lhs, const R& rhs) {
+    return bigint_detail::compare_native(rhs, lhs) < 0;
+}
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, bool> operator<=(const L& lhs, T rhs) {
+    return bigint_detail::compare_native(lhs, rhs) <= 0;
+}
+
+template <typename T, typename R>
+inline bigint_detail::if_mixed<R, T, bool> operator<=(T lhs, const R& rhs) {
+    return bigint_detail::compare_native(rhs, lhs) >= 0;
+}
+
+template <typename L, typename T>
+inline bigint_detail::if_mixed<L, T, bool> operator>=(const L& lhs, T rhs) {
+    return bigint_detail::compare_native(lhs, rhs) >= 0;
+}
+
+template <typename T, typename R>
+inline bigint_detail::if_mixed<R, T, bool> operator>=(T lhs, const R& rhs) {
+    return bigint_detail::compare_native(rhs, lhs) <= 0;
+}
+
+
+// ////////// Shift Operators ////////// //
+
+// shifting left multiplies the magnitude by 2^shift
+inline BigInt& BigInt::operator<<=(size_t shift) {
+    bool is_negative = negative;
+    negative = false;
+    *this = bigint_detail::shift_left_bits(std::move(*this), shift);
+    negative = is_negative && size() > 0;
+    return *this;
+}
+
+// shifting right divides by 2^shift and rounds down, so negative numbers behave as in two's complement
+inline BigInt& BigInt::operator>>=(size_t shift) {
+    if (size() == 0) {
+        return *this;
+    }
+    bool round_away = negative && bigint_detail::trailing_zeros(*this) < shift;  // a set bit is shifted out
+    bigint_detail::shift_right_in_place(*this, shift);
+    if (round_away) {
+        negative = false;
+        *this += 1;
+        negative = true;
+    }
+    return *this;
+}
+
+inline BigInt operator<<(BigInt lhs, size_t shift) {
+    lhs <<= shift;
+    return lhs;
+}
+
+inline BigInt operator>>(BigInt lhs, size_t shift) {
+    lhs >>= shift;
+    return lhs;
+}
+
+
+// ////////// Expression Templates ////////// //
+
+// opt-in lazy evaluation for the compound expressions that show up in inner loops. Wrapping the first operand
+// in lazy() builds a small expression object instead of computing anything; assigning it to a BigInt
+// evaluates the whole expression in one pass with a fused kernel and no intermediate BigInts:
+//     x = lazy(a) * b + c;      // addmul: c + a * b (also c - a * b, a * b - c)
+//     x = lazy(a) * b % m;      // mulmod: the product goes straight into the division
+//     x = (lazy(a) + b) >> 1;   // add-and-shift (also a - b, and any shift)
+// The expression only holds references to its operands, so evaluate it in the same statement (don't store
+// one with auto). Anything else falls back to the ordinary operators.
+namespace bigint_detail {
+
+template <typename Derived>
+struct Expression {
+    // evaluating into a fresh BigInt lets x = lazy(x) * y + z read x while the result is being built
+    operator BigInt() const {
+        BigInt result;
+        static_cast<const Derived&>(*this).evaluate(result);
+        return result;
+    }
+};
+
+// a BigInt marked for lazy evaluation: only starts an expression
+struct LazyBigInt {
+    const BigInt& value;
+};
+
+// a * b
+struct Product : Expression<Product> {
+    const BigInt& a;
+    const BigInt& b;
+    Product(const BigInt& a, const BigInt& b) : a(a), b(b) {}
+
+    // |a * b| into a buffer of exactly a.size() + b.size() limbs
+    void magnitude(LimbVector& result) const {
+        result.assign(a.size() + b.size(), 0);
+        if (a.size() == 0 || b.size() == 0) {
+            return;
+        }
+        if (a.size() >= b.size()) {
+            mul(result.data(), a.number.data(), a.size(), b.number.data(), b.size());
+        }
+        else {
+            mul(result.data(), b.number.data(), b.size(), a.number.data(), a.size());
+        }
+    }
+
+    bool is_negative() const {
+        return a.negative != b.negative;
+    }
+
+    void evaluate(BigInt& destination) const {
+        LimbVector result;
+        magnitude(result);
+        destination.number.swap(result);
+        destination.negative = is_negative();
+        destination.trim();
+    }
+};
+
+// c + a * b, with either term negated
+struct ProductSum : Expression<ProductSum> {
+    Product product;
+    const BigInt& c;
+    bool product_negated;
+    bool c_negated;
+    ProductSum(const Product& product, const BigInt& c, bool product_negated, bool c_negated)
+        : product(product), c(c), product_negated(product_negated), c_negated(c_negated) {}
+
+    void evaluate(BigInt& destination) const {
+        bool product_negative = product.is_negative() != product_negated;
+        bool c_negative = c.negative != c_negated;
+        const BigInt& a = product.a.size() >= product.b.size() ? product.a : product.b;
+        const BigInt& b = product.a.size() >= product.b.size() ? product.b : product.a;
+
+        LimbVector result;
+        bool negative = c_negative;
+        if (b.size() == 0) {
+            result = c.number;
+        }
+
+        // one-limb factor: c's limbs are updated in place with a single multiply-add (or subtract) pass
+        else if (b.size() == 1) {
+            size_t length = std::max(c.size(), a.size()) + 1;
+            result.assign(c.number.begin(), c.number.end());
+            result.resize(length, 0);
+            if (product_negative == c_negative) {
+                limb carry = addmul_1(result.data(), a.number.data(), a.size(), b.number[0]);
+                add_1(result.data() + a.size(), result.data() + a.size(), length - a.size(), carry);
+            }
+            else {
+                limb borrow = submul_1(result.data(), a.number.data(), a.size(), b.number[0]);
+                if (sub(result.data() + a.size(), result.data() + a.size(), length - a.size(), &borrow, 1) != 0) {
+                    // |a * b| > |c|: the limbs hold the two's complement of the answer, so negate them
+                    for (limb& l : result) {
+                        l = ~l;
+                    }
+                    add_1(result.data(), result.data(), length, 1);
+                    negative = product_negative;
+                }
+            }
+        }
+
+        // general case: the product is built in the result buffer, then c is added or subtracted in place
+        else {
+            product.magnitude(result);
+            size_t product_size = result.size();
+            while (product_size > 0 && result[product_size - 1] == 0) {
+                product_size--;
+            }
+            if (product_negative == c_negative) {
+                size_t length = std::max<size_t>(product_size, c.size());
+                result.resize(length + 1, 0);
+                if (product_size >= c.size()) {
+                    result[length] = add(result.data(), result.data(), product_size, c.number.data(), c.size());
+                }
+                else {
+                    result[length] = add(result.data(), c.number.data(), c.size(), result.data(), product_size);
+                }
+            }
+            else if (cmp(result.data(), product_size, c.number.data(), c.size()) >= 0) {
+                sub(result.data(), result.data(), product_size, c.number.data(), c.size());
+                negative = product_negative;
+            }
+            else {
+                result.resize(c.size(), 0);
+                sub(result.data(), c.number.data(), c.size(), result.data(), product_size);
+            }
+        }
+
+        destination.number.swap(result);
+        destination.negative = negative;
+        destination.trim();
+    }
+};
+
+// a * b % m, the remainder taking the product's sign (as with %)
+struct ProductMod : Expression<ProductMod> {
+    Product product;
+    const BigInt& m;
+    ProductMod(const Product& product, const BigInt& m) : product(product), m(m) {}
+
+    void evaluate(BigInt& destination) const {
+        if (m.size() == 0) {
+            throw std::domain_error("BigInt: division by zero");
+        }
+        LimbVector full;
+        product.magnitude(full);
+        size_t n = full.size();
+        while (n > 0 && full[n - 1] == 0) {
+            n--;
+        }
+
+        LimbVector result;
+        if (n < m.size()) {
+            full.resize(n);
+            result.swap(full);
+        }
+        else if (m.size() == 1) {
+            result.assign(1, divrem_1(full.data(), full.data(), n, m.number[0]));
+        }
+        else if (m.size() < BigInt::burnikel_ziegler_threshold) {
+            ScratchScope scratch;
+            result.resize(m.size());
+            divrem_knuth(scratch.allocate(n - m.size() + 1), result.data(), full.data(), n, m.number.data(), m.size());
+        }
+        else {
+            BigInt dividend, quotient, remainder;
+            full.resize(n);
+            dividend.number.swap(full);
+            BigInt divisor = m;
+            divisor.negative = false;
+            divmod_magnitude(dividend, divisor, quotient, remainder);
+            result.swap(remainder.number);
+        }
+
+        destination.number.swap(result);
+        destination.negative = product.is_negative();
+        destination.trim();
+    }
+};
+
+// (a + b) >> shift, or (a - b) >> shift, rounding down like BigInt::operator>>=
+struct SumShift : Expression<SumShift> {
+    const BigInt& a;
+    const BigInt& b;
+    bool subtract;
+    size_t shift;
+    SumShift(const BigInt& a, const BigInt& b, bool subtract, size_t shift) : a(a), b(b), subtract(subtract), shift(shift) {}
+
+    void evaluate(BigInt& destination) const {
+        BigInt result;
+        result.number.reserve(std::max<size_t>(a.size(), b.size()) + 1);
+        result.number = a.number;
+        result.negative = a.negative;
+        result.add_signed(b, b.negative != subtract);  // adds into the one buffer, which the shift then reuses
+        result >>= shift;
+        destination.swap(result);
+    }
+};
+
+// a + b or a - b, only as the operand of a shift
+struct Sum {
+    const BigInt& a;
+    const BigInt& b;
+    bool subtract;
+};
+
+inline Product operator*(const LazyBigInt& a, const BigInt& b) {
+    return Product(a.value, b);
+}
+
+inline ProductSum operator+(const Product& p, const BigInt& c) {
+    return ProductSum(p, c, false, false);
+}
+
+inline ProductSum operator+(const BigInt& c, const Product& p) {
+    return ProductSum(p, c, false, false);
+}
+
+inline ProductSum operator-(const Product& p, const BigInt& c) {
+    return ProductSum(p, c, false, true);
+}
+
+inline ProductSum operator-(const BigInt& c, const Product& p) {
+    return ProductSum(p, c, true, false);
+}
+
+// expiring right or left operands: the same expressions, declared so they beat the BigInt&& arithmetic overloads
+inline ProductSum operator+(const Product& p, BigInt&& c) {
+    return ProductSum(p, c, false, false);
+}
+
+inline ProductSum operator+(BigInt&& c, const Product& p) {
+    return ProductSum(p, c, false, false);
+}
+
+inline ProductSum operator-(const Product& p, BigInt&& c) {
+    return ProductSum(p, c, false, true);
+}
+
+inline ProductSum operator-(BigInt&& c, const Product& p) {
+    return ProductSum(p, c, true, false);
+}
+
+inline ProductMod operator%(const Product& p, const BigInt& m) {
+    return ProductMod(p, m);
+}
+
+inline Sum operator+(const LazyBigInt& a, const BigInt& b) {
+    return Sum{a.value, b, false};
+}
+
+inline Sum operator-(const LazyBigInt& a, const BigInt& b) {
+    return Sum{a.value, b, true};
+}
+
+inline SumShift operator>>(const Sum& sum, size_t shift) {
+    return SumShift(sum.a, sum.b, sum.subtract, shift);
+}
+
+}  // namespace bigint_detail
+
+// starts a lazily evaluated expression (see Expression Templates above)
+inline bigint_detail::LazyBigInt lazy(const BigInt& value) {
+    return bigint_detail::LazyBigInt{value};
+}
+
+
+// ////////// Exponentiation Engine ////////// //
+
+namespace bigint_detail {
+
+// picks the window size for an exponent of the given length: bigger windows cost a bigger table up
+// front but fewer multiplications per exponent bit
+inline unsigned int window_size(size_t bits) {
+    if (bits > 671) { return 6; }
+    if (bits > 239) { return 5; }
+    if (bits > 79) { return 4; }
+    if (bits > 23) { return 3; }
+    return 1;
+}
+
+// left-to-right sliding window exponentiation over any multiplication: scans the exponent's bits
+// directly, squares once per bit, and multiplies once per window by an odd power from a precomputed
+// table (base^1, base^3, base^5, ...); runs of zero bits cost only squarings
+template <typename Element, typename Multiply, typename Square>
+inline Element sliding_window_pow(const Element& base, const Element& one, const BigInt& exponent, Multiply multiply, Square square) {
+    size_t bits = exponent.bit_length();
+    unsigned int window = window_size(bits);
+
+    // table[i] = base^(2i + 1)
+    std::vector<Element> table(1, base);
+    if (window > 1) {
+        Element base_squared = base;
+        square(base_squared);
+        for (size_t i = 1; i < ((size_t)1 << (window - 1)); i++) {
+            table.push_back(table.back());
+            multiply(table.back(), base_squared);
+        }
+    }
+
+    Element result = one;
+    bool started = false;  // until the first window, result is 1 and squaring it would be wasted work
+    for (size_t i = bits; i > 0; ) {
+        if (!exponent.test_bit(i - 1)) {
+            if (started) {
+                square(result);
+            }
+            i--;
+            continue;
+        }
+
+        // the longest window of at most `window` bits, starting at bit i-1, that ends in a 1 bit
+        size_t low = i > window ? i - window : 0;
+        while (!exponent.test_bit(low)) {
+            low++;
+        }
+        size_t value = 0;
+        for (size_t j = i; j-- > low; ) {
+            value = (value << 1) | exponent.test_bit(j);
+        }
+
+        if (started) {
+            for (size_t j = low; j < i; j++) {
+                square(result);
+            }
+            multiply(result, table.at(value / 2));
+        }
+        else {
+            result = table.at(value / 2);
+            started = true;
+        }
+        i = low;
+    }
+    return result;
+}
+
+}  // namespace bigint_detail
+
+
+// ////////// Montgomery Arithmetic ////////// //
+
+// precomputed constants for repeated multiplication modulo one odd number N with n limbs: values are kept
+// in Montgomery form (x * R mod N, with R = 2^(64n)), where a product only needs a REDC -- n multiply-adds
+// of one limb each -- instead of a division. Build one per modulus and reuse it (ex: for every mod_pow)
+class MontgomeryContext {
+public:
+    typedef bigint_detail::limb limb;
+
+    MontgomeryContext(const BigInt&);  // ex: MontgomeryContext context(someOddModulus)
+
+    BigInt modulus;  // N (odd, greater than 1)
+    size_t n;  // number of limbs in N
+    limb n_prime;  // -N^-1 mod 2^64
+    std::vector<limb> r_squared;  // R^2 mod N, padded to n limbs, for converting into Montgomery form
+    std::vector<limb> one;  // R mod N, padded to n limbs (1 in Montgomery form)
+
+    // limb array interface: operands and results are n-limb arrays below N, scratch holds 2n limbs
+    void reduce(limb*, limb*) const;  // result = t / R mod N for a 2n-limb t < N * R (t is used as scratch)
+    void mul(limb*, const limb*, const limb*, limb*) const;  // result = a * b / R mod N
+    void sqr(limb*, const limb*, limb*) const;  // result = a * a / R mod N
+    void pow(limb*, const limb*, const BigInt&, limb*) const;  // result = x^exponent for x in Montgomery form (result must not alias x)
+
+    // BigInt interface
+    BigInt to_montgomery(const BigInt&) const;  // returns x * R mod N
+    BigInt from_montgomery(const BigInt&) const;  // returns x / R mod N
+    BigInt multiply(const BigInt&, const BigInt&) const;  // returns a * b / R mod N for a and b in Montgomery form
+    BigInt square(const BigInt&) const;  // returns a * a / R mod N for a in Montgomery form
+    BigInt pow(const BigInt&, const BigInt&) const;  // returns base^exponent mod N (plain values in and out), sliding window
+    BigInt pow_constant_time(const BigInt&, const BigInt&) const;  // same, with a fixed window and no secret-dependent branches or lookups
+
+    std::vector<limb> padded(const BigInt&) const;  // returns a BigInt below N as an n-limb array
+    BigInt unpadded(const limb*) const;  // returns an n-limb array as a BigInt
+};
+
+// precomputes N', R mod N and R^2 mod N
+inline MontgomeryContext::MontgomeryContext(const BigInt& mod) {
+    if (mod.negative || mod.size() == 0 || mod.number.at(0) % 2 == 0 || mod == 1) {
+        throw std::domain_error("MontgomeryContext: the modulus must be odd and greater than 1");
+    }
+    modulus = mod;
+    n = mod.size();
+
+    // N' = -N^-1 mod 2^64, by Newton's iteration on the lowest limb
+    limb inverse = modulus.number.at(0);
+    for (int i = 0; i < 5; i++) {
+        inverse *= 2 - modulus.number.at(0) * inverse;
+    }
+    n_prime = (limb)0 - inverse;
+
+    BigInt r;
+    r.number.assign(n + 1, 0);
+    r.number.at(n) = 1;  // R = 2^(64n)
+    one = padded(r % modulus);
+
+    BigInt r2;
+    r2.number.assign(2 * n + 1, 0);
+    r2.number.at(2 * n) = 1;  // R^2
+    r_squared = padded(r2 % modulus);
+}
+
+// Montgomery reduction (REDC): adds multiples of N to t until its low n limbs are zero, then drops them;
+// the final correction below N is done with a mask rather than a branch, so timing doesn't depend on t
+inline void MontgomeryContext::reduce(limb* result, limb* t) const {
+    const limb* mod = modulus.number.data();
+
+    // each step clears t[i]; the carry out of t[i+n-1] is parked in t[i] and added back at the end
+    for (size_t i = 0; i < n; i++) {
+        limb m = t[i] * n_prime;
+        t[i] = bigint_detail::addmul_1(t + i, mod, n, m);
+    }
+    limb carry = bigint_detail::add(t + n, t + n, n, t, n);
+
+    // t[n .. 2n) (+ carry * R) is below 2N: subtract N once if it's at least N
+    limb borrow = bigint_detail::sub(result, t + n, n, mod, n);
+    limb keep = (limb)0 - (limb)(borrow & ~carry & 1);  // all ones when t[n .. 2n) was already below N
+    for (size_t i = 0; i < n; i++) {
+        result[i] = (t[n + i] & keep) | (result[i] & ~keep);
+    }
+}
+
+// Montgomery multiplication: the full product, then one reduction
+inline void MontgomeryContext::mul(limb* result, const limb* a, const limb* b, limb* scratch) const {
+    bigint_detail::mul(scratch, a, n, b, n);
+    reduce(result, scratch);
+}
+
+// Montgomery squaring, using the multiplication engine's squaring paths
+inline void MontgomeryContext::sqr(limb* result, const limb* a, limb* scratch) const {
+    bigint_detail::mul(scratch, a, n, a, n);
+    reduce(result, scratch);
+}
+
+// returns a BigInt as an n-limb array, reducing it into [0, N) first if needed
+inline std::vector<MontgomeryContext::limb> MontgomeryContext::padded(const BigInt& x) const {
+    BigInt value = x;
+    if (value.negative || bigint_detail::cmp(value.number.data(), value.size(), modulus.number.data(), n) >= 0) {
+        value %= modulus;
+        if (value.negative) {
+            value += modulus;
+        }
+    }
+    std::vector<limb> result(n, 0);
+    std::copy(value.number.begin(), value.number.end(), result.begin());
+    return result;
+}
+
+// returns an n-limb array as a BigInt
+inline BigInt MontgomeryContext::unpadded(const limb* a) const {
+    BigInt result;
+    result.number.assign(a, a + n);
+    result.trim();
+    return result;
+}
+
+// x * R mod N, as the Montgomery product of x and R^2
+inline BigInt MontgomeryContext::to_montgomery(const BigInt& x) const {
+    std::vector<limb> value = padded(x), result(n);
+    bigint_detail::ScratchScope scratch;
+    mul(result.data(), value.data(), r_squared.data(), scratch.allocate(2 * n));
+    return unpadded(result.data());
+}
+
+// x / R mod N, as a reduction of x itself
+inline BigInt MontgomeryContext::from_montgomery(const BigInt& x) const {
+    bigint_detail::ScratchScope arena;
+    limb* scratch = arena.allocate_zeroed(2 * n);
+    std::vector<limb> value = padded(x), result(n);
+    std::copy(value.begin(), value.end(), scratch);
+    reduce(result.data(), scratch);
+    return unpadded(result.data());
+}
+
+inline BigInt MontgomeryContext::multiply(const BigInt& a, const BigInt& b) const {
+    std::vector<limb> x = padded(a), y = padded(b), result(n);
+    bigint_detail::ScratchScope scratch;
+    mul(result.data(), x.data(), y.data(), scratch.allocate(2 * n));
+    return unpadded(result.data());
+}
+
+inline BigInt MontgomeryContext::square(const BigInt& a) const {
+    std::vector<limb> x = padded(a), result(n);
+    bigint_detail::ScratchScope scratch;
+    sqr(result.data(), x.data(), scratch.allocate(2 * n));
+    return unpadded(result.data());
+}
+
+// sliding window exponentiation like sliding_window_pow, on n-limb arrays with the table of odd powers in the
+// scratch arena, so a whole exponentiation allocates nothing
+inline void MontgomeryContext::pow(limb* result, const limb* x, const BigInt& exponent, limb* scratch) const {
+    size_t bits = exponent.bit_length();
+    unsigned int window = bigint_detail::window_size(bits);
+
+    // table[i] = x^(2i + 1)
+    bigint_detail::ScratchScope arena;
+    limb* table = arena.allocate(n << (window - 1));
+    std::copy(x, x + n, table);
+    if (window > 1) {
+        limb* x_squared = arena.allocate(n);
+        sqr(x_squared, x, scratch);
+        for (size_t i = 1; i < ((size_t)1 << (window - 1)); i++) {
+            mul(table + i * n, table + (i - 1) * n, x_squared, scratch);
+        }
+    }
+
+    std::copy(one.begin(), one.end(), result);
+    bool started = false;  // until the first window, result is 1 and squaring it would be wasted work
+    for (size_t i = bits; i > 0; ) {
+        if (!exponent.test_bit(i - 1)) {
+            if (started) {
+                sqr(result, result, scratch);
+            }
+            i--;
+            continue;
+        }
+
+        // the longest window of at most `window` bits, starting at bit i-1, that ends in a 1 bit
+        size_t low = i > window ? i - window : 0;
+        while (!exponent.test_bit(low)) {
+            low++;
+        }
+        size_t value = 0;
+        for (size_t j = i; j-- > low; ) {
+            value = (value << 1) | exponent.test_bit(j);
+        }
+
+        const limb* entry = table + (value / 2) * n;
+        if (started) {
+            for (size_t j = low; j < i; j++) {
+                sqr(result, result, scratch);
+            }
+            mul(result, result, entry, scratch);
+        }
+        else {
+            std::copy(entry, entry + n, result);
+            started = true;
+        }
+        i = low;
+    }
+}
+
+// modular exponentiation by sliding window, entirely in Montgomery form
+inline BigInt MontgomeryContext::pow(const BigInt& base, const BigInt& exponent) const {
+    bigint_detail::ScratchScope arena;
+    limb* scratch = arena.allocate(2 * n);
+    limb* x = arena.allocate(n);
+    limb* result = arena.allocate(n);
+    std::vector<limb> b = padded(base);
+    mul(x, b.data(), r_squared.data(), scratch);  // base in Montgomery form
+    pow(result, x, exponent, scratch);
+
+    // back out of Montgomery form
+    std::fill(scratch, scratch + 2 * n, 0);
+    std::copy(result, result + n, scratch);
+    reduce(result, scratch);
+    return unpadded(result);
+}
+
+// modular exponentiation for secret exponents: every window (over as many bits as the modulus, or the
+// exponent if it is longer) does the same squarings and one multiplication, by a table entry that is
+// picked by reading the whole table through masks, so neither timing nor memory access depends on the
+// exponent's bits; the products use the elementary kernels, whose work depends only on the length
+inline BigInt MontgomeryContext::pow_constant_time(const BigInt& base, const BigInt& exponent) const {
+    bigint_detail::ScratchScope arena;
+    limb* scratch = arena.allocate(2 * n);
+    std::vector<limb> x(n);
+    std::vector<limb> b = padded(base);
+    auto multiply = [&](limb* r, const limb* p, const limb* q) {
+        bigint_detail::mul_basecase(scratch, p, n, q, n);
+        reduce(r, scratch);
+    };
+    multiply(x.data(), b.data(), r_squared.data());  // base in Montgomery form
+
+    size_t bits = std::max(exponent.bit_length(), modulus.bit_length());
+    unsigned int window = std::max(bigint_detail::window_size(bits), 2u);
+    size_t entries = (size_t)1 << window;
+
+    // table[i] = base^i, stored back to back
+    std::vector<limb> table(entries * n);
+    std::copy(one.begin(), one.end(), table.begin());
+    std::copy(x.begin(), x.end(), table.begin() + n);
+    for (size_t i = 2; i < entries; i++) {
+        multiply(table.data() + i * n, table.data() + (i - 1) * n, x.data());
+    }
+
+    std::vector<limb> result = one, entry(n);
+    size_t windows = (bits + window - 1) / window;
+    for (size_t w = windows; w-- > 0; ) {
+        for (unsigned int j = 0; j < window; j++) {
+            multiply(result.data(), result.data(), result.data());
+        }
+
+        size_t value = 0;
+        for (unsigned int j = window; j-- > 0; ) {
+            value = (value << 1) | exponent.test_bit(w * window + j);
+        }
+
+        // entry = table[value], reading every entry
+        std::fill(entry.begin(), entry.end(), 0);
+        for (size_t i = 0; i < entries; i++) {
+            limb difference = (limb)(i ^ value);
+            limb mask = ((difference | ((limb)0 - difference)) >> 63) - 1;  // all ones only when i == value
+            for (size_t k = 0; k < n; k++) {
+                entry[k] |= table[i * n + k] & mask;
+            }
+        }
+        multiply(result.data(), result.data(), entry.data());
+    }
+
+    // back out of Montgomery form
+    std::fill(scratch, scratch + 2 * n, 0);
+    std::copy(result.begin(), result.end(), scratch);
+    reduce(result.data(), scratch);
+    return unpadded(result.data());
+}
+
+
+// ////////// Primality Tests ////////// //
+
+namespace bigint_detail {
+
+// the primes below 2000, sieved once on first use
+inline const std::vector<uint32_t>& small_primes() {
+    static const std::vector<uint32_t> primes = []() {
+        std::vector<uint32_t> result;
+        std::vector<bool> composite(2000, false);
+        for (uint32_t i = 2; i < 2000; i++) {
+            if (!composite[i]) {
+                result.push_back(i);
+                for (uint32_t j = i * i; j < 2000; j += i) {
+                    composite[j] = true;
+                }
+            }
+        }
+        return result;
+    }();
+    return primes;
+}
+
+// trial division by the small primes: returns 0 if n is composite, 1 if it is prime, -1 if undecided;
+// the primes are grouped so n is only reduced once per group (by their product, which fits a limb)
+inline int trial_division(const BigInt& n) {
+    const std::vector<uint32_t>& primes = small_primes();
+    bool small = n.size() == 1 && n.number.at(0) < (limb)primes.back() * primes.back();
+
+    for (size_t i = 0; i < primes.size(); ) {
+        limb product = 1;
+        size_t end = i;
+        while (end < primes.size() && product <= ~(limb)0 / primes[end]) {
+            product *= primes[end];
+            end++;
+        }
+        limb remainder = mod_1(n.number.data(), n.size(), product);
+        for (; i < end; i++) {
+            if (remainder % primes[i] == 0) {
+                return n.size() == 1 && n.number.at(0) == primes[i] ? 1 : 0;
+            }
+        }
+    }
+    return small ? 1 : -1;  // no factor below 2000 and n < 2000^2 means n is prime
+}
+
+// deterministic Miller-Rabin for a single limb n > 2 (odd), in unsigned __int128 arithmetic: the first
+// twelve prime bases prove primality for every n below 2^64
+inline limb mulmod_1(limb a, limb b, limb n) {
+    return (limb)((dlimb)a * b % n);
+}
+
+inline bool is_prime_1(limb n) {
+    limb d = n - 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+    for (limb base : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+        limb x = 1, power = base % n;
+        for (limb e = d; e != 0; e >>= 1) {
+            if (e & 1) {
+                x = mulmod_1(x, power, n);
+            }
+            power = mulmod_1(power, power, n);
+        }
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        int r = 1;
+        for (; r < s; r++) {
+            x = mulmod_1(x, x, n);
+            if (x == n - 1) {
+                break;
+            }
+        }
+        if (r == s) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// n-limb arithmetic mod m for operands in [0, m), used by the tests below so a round works in place on
+// scratch arrays (r may alias a or b)
+inline bool is_zero_n(const limb* a, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool equal_n(const limb* a, const limb* b, size_t n) {
+    return std::equal(a, a + n, b);
+}
+
+inline void add_mod_n(limb* r, const limb* a, const limb* b, const limb* m, size_t n) {
+    limb carry = add(r, a, n, b, n);
+    if (carry || cmp(r, significant_limbs(r, n), m, n) >= 0) {
+        sub(r, r, n, m, n);
+    }
+}
+
+inline void sub_mod_n(limb* r, const limb* a, const limb* b, const limb* m, size_t n) {
+    if (sub(r, a, n, b, n)) {
+        add(r, r, n, m, n);
+    }
+}
+
+// a / 2 mod m for an odd m
+inline void half_mod_n(limb* r, const limb* a, const limb* m, size_t n) {
+    limb carry = 0;
+    if (a[0] & 1) {
+        carry = add(r, a, n, m, n);
+    }
+    else {
+        std::copy(a, a + n, r);
+    }
+    rshift(r, r, n, 1);
+    r[n - 1] |= carry << (limb_bits - 1);
+}
+
+// one Miller-Rabin round: with n - 1 = d * 2^s, n is a strong probable prime to this base when
+// base^d = 1 or base^(d * 2^r) = -1 (mod n) for some r < s. The base and minus_one (-1) are n-limb arrays in
+// Montgomery form, x is n limbs of working space and scratch 2n
+inline bool miller_rabin(const MontgomeryContext& context, const limb* minus_one, const BigInt& d, size_t s, const limb* base, limb* x, limb* scratch) {
+    size_t n = context.n;
+    context.pow(x, base, d, scratch);
+    if (equal_n(x, context.one.data(), n) || equal_n(x, minus_one, n)) {
+        return true;
+    }
+    for (size_t r = 1; r < s; r++) {
+        context.sqr(x, x, scratch);
+        if (equal_n(x, minus_one, n)) {
             return true;
         }
-        else {
+    }
+    return false;
+}
+
+// the Jacobi symbol (a/m) for an odd m > 0
+inline int jacobi(limb a, limb m) {
+    int result = 1;
+    a %= m;
+    while (a != 0) {
+        while (a % 2 == 0) {
+            a /= 2;
+            if (m % 8 == 3 || m % 8 == 5) {
+                result = -result;
+            }
+        }
+        std::swap(a, m);
+        if (a % 4 == 3 && m % 4 == 3) {
+            result = -result;
+        }
+        a %= m;
+    }
+    return m == 1 ? result : 0;
+}
+
+// the strong Lucas probable prime test with Selfridge's parameters (D the first of 5, -7, 9, -11, ...
+// with Jacobi symbol (D/n) = -1, P = 1, Q = (1 - D) / 4), for an odd n that is not a perfect square:
+// with n + 1 = d * 2^s, n passes when U_d = 0 or V_(d * 2^r) = 0 (mod n) for some r < s
+inline bool strong_lucas(const BigInt& n, const MontgomeryContext& context) {
+    // find D; a perfect square never gets a -1, so check for one if the search drags on
+    long long D = 5;
+    for (int tries = 0; ; tries++) {
+        limb absolute = D < 0 ? -D : D;
+        int symbol = jacobi(mod_1(n.number.data(), n.size(), absolute), absolute);
+        if ((((absolute - 1) / 2) % 2 == 1) && n.number.at(0) % 4 == 3) {
+            symbol = -symbol;  // quadratic reciprocity, from (n/|D|) to (|D|/n)
+        }
+        if (D < 0 && n.number.at(0) % 4 == 3) {
+            symbol = -symbol;  // (-1/n)
+        }
+        if (symbol == 0 && n != absolute) {
             return false;
         }
+        if (symbol == -1) {
+            break;
+        }
+        if (tries == 10) {
+            if (n.sqrtrem().second == 0) {
+                return false;
+            }
+        }
+        D = D < 0 ? -D + 2 : -(D + 2);
     }
+    BigInt Q = BigInt((1 - D) / 4) % n;
+    if (Q.negative) {
+        Q += n;
+    }
+    limb D_magnitude = D < 0 ? -D : D;
 
-    if (lhs.negative == false && lhs.size() > rhs.size()) {
-        return false;
+    BigInt d = n + 1;
+    size_t s = 0;
+    while (!d.test_bit(s)) {
+        s++;
     }
-    
-    if (lhs.negative == false && lhs.size() < rhs.size()) {
-        return true;
+    d = shift_right_bits(d, s);
+
+    // everything below is in Montgomery form on n-limb scratch arrays, where + - and halving work unchanged
+    size_t k = context.n;
+    const limb* m = context.modulus.number.data();
+    ScratchScope arena;
+    limb* scratch = arena.allocate(2 * k);
+    limb* U = arena.allocate(k);
+    limb* V = arena.allocate(k);
+    limb* Qk = arena.allocate(k);
+    limb* Q_montgomery = arena.allocate_zeroed(k);
+    limb* U_next = arena.allocate(k);
+    limb* DU = arena.allocate(k);
+    limb* product = arena.allocate(k + 1);
+    limb* quotient = arena.allocate(2);
+    std::copy(context.one.begin(), context.one.end(), U);  // U_1 = 1
+    std::copy(context.one.begin(), context.one.end(), V);  // V_1 = P = 1
+    std::copy(Q.number.begin(), Q.number.end(), Q_montgomery);
+    context.mul(Q_montgomery, Q_montgomery, context.r_squared.data(), scratch);
+    std::copy(Q_montgomery, Q_montgomery + k, Qk);
+
+    for (size_t i = d.bit_length() - 1; i-- > 0; ) {
+        // k -> 2k: U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k
+        context.mul(U, U, V, scratch);
+        context.sqr(V, V, scratch);
+        sub_mod_n(V, V, Qk, m, k);
+        sub_mod_n(V, V, Qk, m, k);
+        context.sqr(Qk, Qk, scratch);
+
+        // k -> k + 1: U_(k+1) = (P U_k + V_k) / 2, V_(k+1) = (D U_k + P V_k) / 2
+        if (d.test_bit(i)) {
+            add_mod_n(U_next, U, V, m, k);
+            product[k] = mul_1(product, U, k, D_magnitude);  // one limb times k limbs, reduced with a single quotient limb
+            divrem_knuth(quotient, DU, product, k + 1, m, k);
+            if (D < 0) {
+                sub_mod_n(DU, V, DU, m, k);
+            }
+            else {
+                add_mod_n(DU, DU, V, m, k);
+            }
+            half_mod_n(V, DU, m, k);
+            half_mod_n(U, U_next, m, k);
+            context.mul(Qk, Qk, Q_montgomery, scratch);
+        }
     }
 
-    for (int i = 0; i < lhs.size(); i++) {
-      if (lhs.number.at(i) > rhs.number.at(i)) {
-        return false;
-      }
-      if (lhs.number.at(i) < rhs.number.at(i)) {
+    if (is_zero_n(U, k) || is_zero_n(V, k)) {
         return true;
-      }
     }
-
+    for (size_t r = 1; r < s; r++) {
+        context.sqr(V, V, scratch);
+        sub_mod_n(V, V, Qk, m, k);
+        sub_mod_n(V, V, Qk, m, k);
+        if (is_zero_n(V, k)) {
+            return true;
+        }
+        context.sqr(Qk, Qk, scratch);
+    }
     return false;
 }
 
-bool operator>(BigInt lhs, const BigInt& rhs) {
-    return !(lhs < rhs) && !(lhs == rhs);
+}  // namespace bigint_detail
+
+
+// ////////// Root Extraction ////////// //
+
+namespace bigint_detail {
+
+// floor(n^(1/k)) for a non-negative n and k >= 2 by Newton's iteration x <- ((k - 1) x + n / x^(k - 1)) / k,
+// which decreases monotonically to the root from any starting point at or above it. The start comes from
+// the root of n's top half (n / 2^(k h) has about half the bits), so it is already correct to half the
+// digits and a couple of full-size steps finish: the big divisions work at doubling precisions
+inline BigInt root_floor(const BigInt& n, unsigned int k) {
+    size_t bits = n.bit_length();
+    if (bits <= 1) {
+        return n;  // 0 and 1 are their own roots
+    }
+
+    BigInt x;
+    size_t h = bits / (2 * k);
+    if (h == 0 || bits <= limb_bits) {
+        x = shift_left_bits(BigInt(1), (bits + k - 1) / k);  // 2^ceil(bits / k) is above the root
+    }
+    else {
+        // root(n) < (root(n / 2^(k h)) + 1) * 2^h
+        x = shift_left_bits(root_floor(shift_right_bits(n, k * h), k) + BigInt(1), h);
+    }
+
+    BigInt k_big = BigInt(std::to_string(k));
+    BigInt k_minus_1 = BigInt(std::to_string(k - 1));
+    while (true) {
+        BigInt y;
+        if (k == 2) {
+            y = (lazy(x) + n / x) >> 1;
+        }
+        else {
+            y = (lazy(x) * k_minus_1 + n / x.pow(k_minus_1)) / k_big;
+        }
+        if (y >= x) {
+            return x;
+        }
+        x.swap(y);
+    }
 }
 
-bool operator>=(BigInt lhs, const BigInt& rhs) {
-    return !(lhs < rhs);
+}  // namespace bigint_detail
+
+// returns the integer square root (rounded down); throws std::domain_error for negative numbers
+inline BigInt BigInt::sqrt() const {
+    if (negative) {
+        throw std::domain_error("square root of a negative BigInt");
+    }
+    return bigint_detail::root_floor(*this, 2);
 }
 
-bool operator<=(BigInt lhs, const BigInt& rhs) {
-    return !(lhs > rhs);
+// returns the integer square root s and the remainder r = this - s^2
+inline std::pair<BigInt, BigInt> BigInt::sqrtrem() const {
+    BigInt root = sqrt();
+    BigInt remainder = *this - lazy(root) * root;
+    return std::make_pair(root, remainder);
 }
 
+// returns the integer k-th root, rounded toward zero; negative numbers only have odd roots
+inline BigInt BigInt::iroot(unsigned int k) const {
+    if (k == 0) {
+        throw std::domain_error("zeroth root of a BigInt");
+    }
+    if (k == 1) {
+        return *this;
+    }
+    if (negative) {
+        if (k % 2 == 0) {
+            throw std::domain_error("even root of a negative BigInt");
+        }
+        BigInt magnitude = *this;
+        magnitude.negative = false;
+        BigInt root = bigint_detail::root_floor(magnitude, k);
+        root.negative = root.size() > 0;
+        return root;
+    }
+    return bigint_detail::root_floor(*this, k);
+}
 
-// ////////// Prefix/Postfix Operators ////////// //
 
-// somebigint++
-BigInt& BigInt::operator++(int blank) {   
-    *this = *this + 1;
-    return *this;
-}   
+// ////////// GCD Engine ////////// //
 
-// ++somebigint
-BigInt& BigInt::operator++() {   
-    *this = *this + 1;
-    return *this;
+// the crossover point is tunable: set BigInt::lehmer_threshold before calling gcd
+inline unsigned int BigInt::lehmer_threshold = 3;
+
+namespace bigint_detail {
+
+// bits [shift, shift + 64) of the magnitude of x
+inline limb extract_bits(const BigInt& x, size_t shift) {
+    size_t index = shift / limb_bits;
+    unsigned int bits = shift % limb_bits;
+    if (index >= x.size()) {
+        return 0;
+    }
+    limb result = x.number[index] >> bits;
+    if (bits != 0 && index + 1 < x.size()) {
+        result |= x.number[index + 1] << (limb_bits - bits);
+    }
+    return result;
 }
 
-// somebigint--
-BigInt& BigInt::operator--(int blank) {   
-    *this = *this - 1;
-    return *this;
-}   
+// Stein's binary GCD of two limbs: strip the common factors of two, then subtract the smaller odd value from the larger
+inline limb gcd_1(limb a, limb b) {
+    if (a == 0 || b == 0) {
+        return a | b;
+    }
+    int common = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0) {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            std::swap(a, b);
+        }
+        b -= a;
+    }
+    return a << common;
+}
 
-// --somebigint
-BigInt& BigInt::operator--() {   
-    *this = *this - 1;
-    return *this;
-}   
+// Stein's binary GCD of two positive BigInts: only subtractions and shifts, which beats division for a few limbs
+inline BigInt gcd_binary(BigInt a, BigInt b) {
+    size_t common = std::min(trailing_zeros(a), trailing_zeros(b));
+    shift_right_in_place(a, trailing_zeros(a));
+    shift_right_in_place(b, trailing_zeros(b));
+
+    // both odd: their difference is even, so it always loses at least one bit
+    while (a.size() > 1 || b.size() > 1) {
+        int order = cmp(a.number.data(), a.size(), b.number.data(), b.size());
+        if (order == 0) {
+            return shift_left_bits(a, common);
+        }
+        if (order < 0) {
+            a.swap(b);
+        }
+        sub(a.number.data(), a.number.data(), a.size(), b.number.data(), b.size());
+        a.trim();
+        shift_right_in_place(a, trailing_zeros(a));
+    }
+    return shift_left_bits(from_limb(gcd_1(a.number[0], b.number[0])), common);
+}
+
+// Lehmer's inner loop: runs Euclid's algorithm on the leading 62 bits of a >= b for as long as the quotients
+// provably match the full numbers' (Knuth's test: both (x + A) / (y + C) and (x + B) / (y + D) agree), and
+// collects the steps as the matrix [A B; C D]. Returns false when not even one quotient could be decided
+inline bool lehmer_matrix(const BigInt& a, const BigInt& b, long long& A, long long& B, long long& C, long long& D) {
+    size_t bits = a.bit_length();
+    size_t shift = bits > 62 ? bits - 62 : 0;
+    long long x = extract_bits(a, shift);
+    long long y = extract_bits(b, shift);
+    A = 1, B = 0, C = 0, D = 1;
+    while (y + C != 0 && y + D != 0) {
+        long long q = (x + A) / (y + C);
+        if (q != (x + B) / (y + D)) {
+            break;
+        }
+        long long t = A - q * C;
+        A = C;
+        C = t;
+        t = B - q * D;
+        B = D;
+        D = t;
+        t = x - q * y;
+        x = y;
+        y = t;
+    }
+    return B != 0;
+}
+
+// x * factor for a one-word signed factor
+inline BigInt scale(const BigInt& x, long long factor) {
+    BigInt result;
+    if (factor == 0 || x.size() == 0) {
+        return result;
+    }
+    limb magnitude = factor < 0 ? -(limb)factor : (limb)factor;
+    result.number.resize(x.size() + 1);
+    result.number[x.size()] = mul_1(result.number.data(), x.number.data(), x.size(), magnitude);
+    result.trim();
+    result.negative = (factor < 0) != x.negative;
+    return result;
+}
+
+// (a, b) <- (A a + B b, C a + D b)
+inline void apply_matrix(BigInt& a, BigInt& b, long long A, long long B, long long C, long long D) {
+    BigInt next_a = scale(a, A);
+    next_a += scale(b, B);
+    BigInt next_b = scale(a, C);
+    next_b += scale(b, D);
+    a.swap(next_a);
+    b.swap(next_b);
+}
+
+// Lehmer's GCD of a >= b > 0: each round replaces up to ~30 division steps by four one-word multiplications
+// of the full numbers, and falls back to one full division when the leading words cannot decide a quotient
+inline BigInt gcd_lehmer(BigInt a, BigInt b) {
+    long long A, B, C, D;
+    BigInt quotient, remainder;
+    while (b.size() > 1) {
+        if (lehmer_matrix(a, b, A, B, C, D)) {
+            apply_matrix(a, b, A, B, C, D);
+        }
+        else {
+            divmod_magnitude(a, b, quotient, remainder);
+            a.swap(b);
+            b.swap(remainder);
+        }
+    }
+    if (b.size() == 0) {
+        return a;
+    }
+    limb r = mod_1(a.number.data(), a.size(), b.number[0]);
+    return from_limb(gcd_1(b.number[0], r));
+}
+
+// extended Lehmer: g = gcd(a, b) for a >= b > 0, and s with s a = g (mod b). The cofactor pair (s0, s1)
+// follows the same steps as (a, b), so batches of quotients cost one matrix update there too
+inline void xgcd_lehmer(BigInt a, BigInt b, BigInt& g, BigInt& s) {
+    long long A, B, C, D;
+    BigInt s0 = 1, s1 = 0;
+    BigInt quotient, remainder;
+    while (b.size() > 0) {
+        if (lehmer_matrix(a, b, A, B, C, D)) {
+            apply_matrix(a, b, A, B, C, D);
+            apply_matrix(s0, s1, A, B, C, D);
+        }
+        else {
+            divmod_magnitude(a, b, quotient, remainder);
+            a.swap(b);
+            b.swap(remainder);
+            s0 = s0 - lazy(quotient) * s1;
+            s0.swap(s1);
+        }
+    }
+    g.swap(a);
+    s.swap(s0);
+}
+
+}  // namespace bigint_detail
+
+// returns {g, s, t} with g = gcd(a, b) >= 0 and s a + t b = g (ex: xgcd(240, 46) == {2, -9, 47})
+inline std::tuple<BigInt, BigInt, BigInt> xgcd(const BigInt& a, const BigInt& b) {
+    BigInt a_magnitude = a, b_magnitude = b;
+    a_magnitude.negative = false;
+    b_magnitude.negative = false;
+
+    BigInt g, s, t;
+    if (b_magnitude == 0) {
+        g = a_magnitude;
+        s = a.negative ? -1 : (a_magnitude == 0 ? 0 : 1);
+        return std::make_tuple(g, s, t);
+    }
+    if (a_magnitude == 0) {
+        g = b_magnitude;
+        t = b.negative ? -1 : 1;
+        return std::make_tuple(g, s, t);
+    }
+
+    // run on |a| >= |b|, then derive the other cofactor with one exact division
+    bool swapped = a_magnitude < b_magnitude;
+    if (swapped) {
+        a_magnitude.swap(b_magnitude);
+    }
+    bigint_detail::xgcd_lehmer(a_magnitude, b_magnitude, g, s);
+    t = (g - lazy(s) * a_magnitude) / b_magnitude;
+    if (swapped) {
+        s.swap(t);
+    }
+
+    // cofactors of |a| and |b| become cofactors of a and b
+    if (a.negative) {
+        s = BigInt(0) - s;
+    }
+    if (b.negative) {
+        t = BigInt(0) - t;
+    }
+    return std::make_tuple(g, s, t);
+}
 
 
 // ////////// Useful Functions ////////// //
 
-// returns the length of the number (digits)
-unsigned int BigInt::size() const {
+// returns the length of the number (limbs)
+inline unsigned int BigInt::size() const {
     return number.size();
 }
 
-// finds the square root using a binary search approach
-BigInt BigInt::sqrt() {
-    // edge case: square root of 1
-    if (*this == BigInt(1)) {
-        return BigInt(1);
+// removes any leading zero limbs, so every value has exactly one representation (zero is empty and not negative)
+inline void BigInt::trim() {
+    while (!number.empty() && number.back() == 0) {
+        number.pop_back();
     }
+    if (number.empty()) {
+        negative = false;
+    }
+}
 
-    BigInt root = *this;
-    BigInt midpoint = root / 2;
+// returns the number of bits in the magnitude: 64 per limb, less the leading zeros of the top limb
+inline size_t BigInt::bit_length() const {
+    if (size() == 0) {
+        return 0;
+    }
+    return size() * bigint_detail::limb_bits - __builtin_clzll(number.back());
+}
 
-    BigInt original = root;
-    BigInt low = 0;
-    BigInt high = original;
-    BigInt square;
-    BigInt old_midpoint;
-    std::string trash;
+// returns bit i of the magnitude
+inline bool BigInt::test_bit(size_t i) const {
+    size_t index = i / bigint_detail::limb_bits;
+    return index < size() && (number.at(index) >> (i % bigint_detail::limb_bits)) & 1;
+}
 
-    while (true) {
-        old_midpoint = midpoint;
-        
-        square = midpoint * midpoint;
-        if (square > original) {
-            high = midpoint;
-            midpoint = (midpoint + low) / 2;
-        }
-        else if (square < original) {
-            low = midpoint;
-            midpoint = (midpoint + high) / 2;
-        }
-        
-        if (midpoint == old_midpoint) {
-            break;
-        }
-    }
-    return midpoint;
+// exchanges the limbs and signs of two BigInts
+inline void BigInt::swap(BigInt& other) {
+    number.swap(other.number);
+    std::swap(negative, other.negative);
 }
 
 // calculates a power by exponentiation by squaring
-BigInt BigInt::pow(BigInt power) {
+inline BigInt BigInt::pow(BigInt power) {
     BigInt base = *this;
     BigInt result = 1;
 
-    while (power > 0) {
-        if (power.number.at(power.size()-1) % 2 == 0) {
-            power = power / 2;
-            base = base * base;
-        }
+    // negative powers round down to 1 (as before), so only the bits of a positive power are walked
+    if (power.negative) {
+        return result;
+    }
 
-        else {
-            power = power - 1;
-            result = result * base;
-            power = power / 2;
-            base = base * base;
+    // reads the power's bits from the bottom: multiply in the current square wherever a bit is set
+    size_t bits = power.bit_length();
+    for (size_t i = 0; i < bits; i++) {
+        if (power.test_bit(i)) {
+            result *= base;
+        }
+        if (i + 1 < bits) {
+            base *= base;  // squaring in place lets the multiplication engine use its faster squaring path
         }
     }
 
     return result;
 }
 
-// finds the modular power recursively
-BigInt BigInt::mod_pow(BigInt exponent, BigInt mod) {
-    BigInt base = *this;
+// finds the modular power by sliding window exponentiation
+inline BigInt BigInt::mod_pow(BigInt exponent, BigInt mod) {
+    return mod_pow(exponent, mod, false);
+}
 
-    if (exponent == 1) {
-        return base % mod;
+// finds the modular power: in Montgomery form for odd moduli, reducing with divmod after every product otherwise
+inline BigInt BigInt::mod_pow(BigInt exponent, BigInt mod, bool constant_time) {
+    if (exponent.negative) {
+        throw std::domain_error("BigInt: mod_pow with a negative exponent");
     }
 
-    else {
-        if (exponent % 2 == 1) {
-            BigInt temp = base.mod_pow((exponent - 1) / 2, mod);
-            return ((base * temp * temp) % mod);
-        }
+    // everything is 0 mod 1 (odd, but below what Montgomery form handles)
+    if (mod == 1) {
+        return 0;
+    }
 
-        else {
-            BigInt temp = base.mod_pow(exponent / 2, mod);
-            return (temp * temp) % mod; 
-        }
+    // odd moduli: Montgomery multiplication replaces the division at every step
+    bool odd = mod.size() > 0 && mod.number.at(0) % 2 == 1 && !mod.negative && mod > 1;
+    if (odd) {
+        MontgomeryContext context(mod);
+        return constant_time ? context.pow_constant_time(*this, exponent) : context.pow(*this, exponent);
+    }
+    if (constant_time) {
+        throw std::domain_error("BigInt: constant-time mod_pow needs an odd modulus");
+    }
+
+    BigInt base = *this % mod;
+    if (base.negative) {
+        base += mod;
     }
+    return bigint_detail::sliding_window_pow(base, BigInt(1) % mod, exponent,
+        [&](BigInt& r, const BigInt& y) { r = lazy(r) * y % mod; },
+        [&](BigInt& r) { r = lazy(r) * r % mod; });
 }
 
-// calculates the greatest common denominator using the Extended Euclidean algorithm
-BigInt BigInt::gcd(BigInt b) {
+// returns the greatest common divisor (non-negative): binary GCD for small operands, Lehmer's algorithm for large
+inline BigInt BigInt::gcd(BigInt b) {
     BigInt a = *this;
+    a.negative = false;
+    b.negative = false;
 
-    // edge case: a is 0 (returns b)
+    // edge cases: gcd(a, 0) = a
     if (a == 0) {
         return b;
     }
-
-    // edge case: b is 0 (returns a)
     if (b == 0) {
         return a;
     }
 
-    // ensures a is greater than b, swaps if otherwise
     if (a < b) {
-        a += b;
-        b = a - b;
-        a -= b;
+        a.swap(b);
+    }
+    if (a.size() == 1) {
+        return bigint_detail::from_limb(bigint_detail::gcd_1(a.number[0], b.number[0]));
+    }
+    if (a.size() < lehmer_threshold) {
+        return bigint_detail::gcd_binary(a, b);
+    }
+    return bigint_detail::gcd_lehmer(a, b);
+}
+
+// returns the modular inverse (in [0, b)) from the extended GCD; throws std::domain_error if there is none
+inline BigInt BigInt::mod_inverse(BigInt b) {
+    if (b < 1) {
+        throw std::domain_error("modular inverse with a non-positive modulus");
     }
 
-    // the euclidean algorithm
-    while (a % b != 0) {
+    BigInt a = *this % b;
+    if (a.negative) {
         a += b;
-        b = a - b;
-        a -= b;
-        b %= a;
     }
 
-    return b;
+    BigInt g, s, t;
+    std::tie(g, s, t) = xgcd(a, b);
+    if (g != 1) {
+        throw std::domain_error("BigInt has no modular inverse: not coprime to the modulus");
+    }
+
+    s %= b;
+    if (s.negative) {
+        s += b;
+    }
+    return s;
 }
 
-// adapted from 'www.geeksforgeeks.org'
-// returns the modular inverse using the Extended Euclidean Algorithm
-BigInt BigInt::mod_inverse(BigInt b) {
-    BigInt a = *this;  // reassignment as we change a
-    BigInt b_initial = b;  // reserved in case x becomes negative
-    BigInt x = 1;  // x = 1 because a and b are relatively prime
-    BigInt y = 0;
+// determines primality: deterministic Miller-Rabin below 2^64, Baillie-PSW above
+inline bool BigInt::is_prime() {
+    if (size() <= 1) {
+        return is_prime(PrimalityTest::deterministic);
+    }
+    return is_prime(PrimalityTest::baillie_psw);
+}
 
-    // edge case
-    if (b == 1) {
-      return 0;
+// determines primality with small-prime trial division first, then the chosen probable prime test
+inline bool BigInt::is_prime(PrimalityTest test, unsigned int rounds) {
+    // initial conditions: 0, 1 and negative numbers aren't prime
+    if (negative || *this <= 1) {
+        return false;
     }
-    
 
-    // keeps cycling through the calculation, adjusting a/b/x/y as per the equation, until a <= 1
-    while (a > 1) {
-        // q is quotient
-        BigInt q = a / b;
-        BigInt t = b;
+    int verdict = bigint_detail::trial_division(*this);
+    if (verdict != -1) {
+        return verdict == 1;
+    }
 
-        b = a % b;
-        a = t;
-        t = y;
+    // a single limb is settled exactly (whatever the test) in machine arithmetic
+    if (size() == 1) {
+        return bigint_detail::is_prime_1(number[0]);
+    }
 
-        y = x - q * y;
-        x = t;
+    // n - 1 = d * 2^s with d odd
+    BigInt n_minus_1 = *this - 1;
+    size_t s = 0;
+    while (!n_minus_1.test_bit(s)) {
+        s++;
+    }
+    BigInt d = bigint_detail::shift_right_bits(n_minus_1, s);
+    MontgomeryContext context(*this);
+
+    // the rounds run on scratch arrays: the base and -1 = N - (R mod N) in Montgomery form
+    size_t k = context.n;
+    bigint_detail::ScratchScope arena;
+    limb* scratch = arena.allocate(2 * k);
+    limb* x = arena.allocate(k);
+    limb* base_montgomery = arena.allocate(k);
+    limb* minus_one = arena.allocate(k);
+    bigint_detail::sub(minus_one, number.data(), k, context.one.data(), k);
+    auto passes = [&](const BigInt& base) {  // for 0 < base < n
+        std::fill(base_montgomery, base_montgomery + k, 0);
+        std::copy(base.number.begin(), base.number.end(), base_montgomery);
+        context.mul(base_montgomery, base_montgomery, context.r_squared.data(), scratch);
+        return bigint_detail::miller_rabin(context, minus_one, d, s, base_montgomery, x, scratch);
+    };
+
+    // these bases prove primality below 3317044064679887385961981
+    static constexpr auto deterministic_bound = 3317044064679887385961981_big;
+    if (test == PrimalityTest::deterministic && *this < deterministic_bound) {
+        for (int base : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41}) {
+            if (!passes(base)) {
+                return false;
+            }
+        }
+        return true;
     }
- 
-    // Make sure x is positive
-    if (x < 0) {
-       x += b_initial;
+
+    if (test == PrimalityTest::miller_rabin) {
+        // random bases in [2, n - 2]
+        static thread_local std::mt19937_64 generator(std::random_device{}());
+        BigInt range = *this - 3, base;
+        for (unsigned int i = 0; i < rounds; i++) {
+            base.number.resize(size());
+            for (limb& l : base.number) {
+                l = generator();
+            }
+            base.trim();
+            base %= range;
+            base += 2;
+            if (!passes(base)) {
+                return false;
+            }
+        }
+        return true;
     }
- 
-    return x;  // x is the modular inverse result
+
+    // Baillie-PSW (also the deterministic test's fallback above its bound)
+    return passes(2) && bigint_detail::strong_lucas(*this, context);
 }
 
-// determines primality using the "naive test" -- testing every number up to the square root
-bool BigInt::is_prime() {
-   // initial conditions: even, 5, 0
-    int last_digit = number.at(size()-1);
-    if (last_digit % 2 == 0 && size() >= 2) { return false; }
-    if (last_digit == 5 && size() >= 2) { return false; }
-    if (last_digit == 0) { return false; }
 
-    BigInt i;
-    BigInt j = (*this).sqrt();
+// ////////// Prime Generation ////////// //
+
+// next_prime, random_prime and random_safe_prime walk the odd numbers from a starting point a window at a
+// time: an incremental sieve strikes out the candidates with a factor below 2^16, and the survivors are
+// tested in order (spread over the thread pool under ExecutionPolicy::parallel, where a hit stops the tests
+// of every later survivor)
+namespace bigint_detail {
+
+const uint32_t sieve_prime_limit = (uint32_t)1 << 16;  // candidates are sieved by the odd primes below this
+const size_t sieve_window = 4096;  // odd candidates per window
+const size_t parallel_prime_limbs = 4;  // candidates this long (256 bits) or longer are worth a task each
+
+// the odd primes below sieve_prime_limit, sieved once on first use
+inline const std::vector<uint32_t>& sieve_primes() {
+    static const std::vector<uint32_t> primes = []() {
+        std::vector<uint32_t> result;
+        std::vector<bool> composite(sieve_prime_limit, false);
+        for (uint32_t i = 3; i < sieve_prime_limit; i += 2) {
+            if (!composite[i]) {
+                result.push_back(i);
+                for (uint64_t j = (uint64_t)i * i; j < sieve_prime_limit; j += 2 * i) {
+                    composite[j] = true;
+                }
+            }
+        }
+        return result;
+    }();
+    return primes;
+}
 
-    for (i = 2; i <= j; i = i + 1)
-    {
-        if (*this % i == 0) {
-            return false;
+// the odd candidates start, start + 2, start + 4, ... one window at a time: each window strikes out the
+// candidates c divisible by a sieve prime (and, for safe primes, those whose 2c + 1 is). One residue per
+// prime is kept and moved forward by 2 * sieve_window, so only the first window reduces a BigInt
+class CandidateSieve {
+public:
+    CandidateSieve(const BigInt& start, bool safe);  // start must be odd and at least 3
+
+    const BigInt& start() const;  // the current window's first candidate
+    const std::vector<uint32_t>& survivors() const;  // the offsets k whose candidate start + 2k survived, in order
+    BigInt candidate(uint32_t offset) const;  // returns start + 2 * offset
+    void advance();  // moves on to the next window
+
+private:
+    void sieve();
+
+    BigInt first;
+    bool safe;
+    std::vector<uint32_t> primes;  // the sieve primes below the first candidate, so no candidate is struck out for being one
+    std::vector<uint32_t> residues;  // first mod each prime
+    std::vector<uint32_t> offsets;
+};
+
+inline CandidateSieve::CandidateSieve(const BigInt& start, bool safe) : first(start), safe(safe) {
+    for (uint32_t p : sieve_primes()) {
+        if (start <= p) {
+            break;
         }
+        primes.push_back(p);
     }
-    return true;
+
+    // the residues, reducing the number once per group of primes whose product fits a limb
+    residues.resize(primes.size());
+    for (size_t i = 0; i < primes.size(); ) {
+        limb product = 1;
+        size_t end = i;
+        while (end < primes.size() && product <= ~(limb)0 / primes[end]) {
+            product *= primes[end];
+            end++;
+        }
+        limb remainder = mod_1(first.number.data(), first.size(), product);
+        for (; i < end; i++) {
+            residues[i] = (uint32_t)(remainder % primes[i]);
+        }
+    }
+    sieve();
+}
+
+inline const BigInt& CandidateSieve::start() const {
+    return first;
+}
+
+inline const std::vector<uint32_t>& CandidateSieve::survivors() const {
+    return offsets;
+}
+
+inline BigInt CandidateSieve::candidate(uint32_t offset) const {
+    return first + (limb)2 * offset;
+}
+
+// candidate k is first + 2k, so p divides it when k = -r / 2 (mod p), and divides 2(first + 2k) + 1 when k = -(2r + 1) / 4
+inline void CandidateSieve::sieve() {
+    std::vector<char> composite(sieve_window, 0);
+    for (size_t i = 0; i < primes.size(); i++) {
+        uint64_t p = primes[i], r = residues[i];
+        uint64_t half = (p + 1) / 2;  // 1/2 mod p
+        for (size_t k = (p - r) % p * half % p; k < sieve_window; k += p) {
+            composite[k] = 1;
+        }
+        if (safe) {
+            for (size_t k = (p - (2 * r + 1) % p) % p * half % p * half % p; k < sieve_window; k += p) {
+                composite[k] = 1;
+            }
+        }
+    }
+    offsets.clear();
+    for (uint32_t k = 0; k < sieve_window; k++) {
+        if (!composite[k]) {
+            offsets.push_back(k);
+        }
+    }
+}
+
+inline void CandidateSieve::advance() {
+    first += (limb)2 * sieve_window;
+    for (size_t i = 0; i < primes.size(); i++) {
+        residues[i] = (uint32_t)((residues[i] + 2 * sieve_window) % primes[i]);
+    }
+    sieve();
+}
+
+// the index of the first of the window's survivors that passes test, or -1 if none does. In parallel, thread_count()
+// tasks take the survivors in order from a shared counter, and once one passes no task starts a later one, so
+// the result is the same as a sequential search (only the tests already running finish)
+template <typename Test>
+inline long first_passing(const CandidateSieve& sieve, const Test& test) {
+    const std::vector<uint32_t>& offsets = sieve.survivors();
+    if (!parallel_enabled() || sieve.start().size() < parallel_prime_limbs) {
+        for (size_t i = 0; i < offsets.size(); i++) {
+            if (test(sieve.candidate(offsets[i]))) {
+                return (long)i;
+            }
+        }
+        return -1;
+    }
+
+    std::atomic<size_t> next{0}, best{offsets.size()};
+    auto search = [&]() {
+        for (size_t i = next++; i < offsets.size() && i < best.load(); i = next++) {
+            if (test(sieve.candidate(offsets[i]))) {
+                size_t current = best.load();
+                while (i < current && !best.compare_exchange_weak(current, i)) {
+                }
+            }
+        }
+    };
+    TaskGroup group;
+    for (unsigned int t = 1; t < BigInt::thread_count(); t++) {
+        group.run(search);
+    }
+    search();
+    group.wait();
+    return best.load() < offsets.size() ? (long)best.load() : -1;
+}
+
+// a uniformly random number below 2^bits
+template <typename Generator>
+inline BigInt random_bits(size_t bits, Generator& generator) {
+    std::uniform_int_distribution<limb> distribution;
+    BigInt result;
+    result.number.resize((bits + limb_bits - 1) / limb_bits);
+    for (limb& l : result.number) {
+        l = distribution(generator);
+    }
+    if (bits % limb_bits != 0) {
+        result.number.back() &= ((limb)1 << (bits % limb_bits)) - 1;
+    }
+    result.trim();
+    return result;
+}
+
+// the first candidate below 2^bits that passes test, searching up from a random odd bits-bit start (and from a
+// new start whenever the search runs past 2^bits)
+template <typename Generator, typename Test>
+inline BigInt random_search(size_t bits, Generator& generator, bool safe, const Test& test) {
+    BigInt bound = BigInt(1) << bits;
+    while (true) {
+        BigInt start = random_bits(bits, generator);
+        start.number.resize((bits + limb_bits - 1) / limb_bits);
+        start.number.back() |= (limb)1 << ((bits - 1) % limb_bits);
+        start.number[0] |= 1;
+        for (CandidateSieve sieve(start, safe); sieve.start() < bound; sieve.advance()) {
+            long hit = first_passing(sieve, test);
+            if (hit >= 0) {
+                BigInt found = sieve.candidate(sieve.survivors()[hit]);
+                if (found < bound) {
+                    return found;
+                }
+                break;
+            }
+        }
+    }
+}
+
+}  // namespace bigint_detail
+
+// the smallest prime greater than n
+inline BigInt next_prime(const BigInt& n) {
+    if (n < 2) {
+        return 2;
+    }
+    BigInt start = n + 1;
+    if (!start.test_bit(0)) {
+        start += 1;
+    }
+    for (bigint_detail::CandidateSieve sieve(start, false); ; sieve.advance()) {
+        long hit = bigint_detail::first_passing(sieve, [](BigInt candidate) { return candidate.is_prime(); });
+        if (hit >= 0) {
+            return sieve.candidate(sieve.survivors()[hit]);
+        }
+    }
+}
+
+// a random prime of exactly the given number of bits, at least 2
+template <typename Generator>
+inline BigInt random_prime(size_t bits, Generator& generator) {
+    if (bits < 2) {
+        throw std::domain_error("BigInt: random_prime needs at least 2 bits");
+    }
+    return bigint_detail::random_search(bits, generator, false, [](BigInt candidate) { return candidate.is_prime(); });
+}
+
+// a random safe prime p = 2q + 1 (q prime too) of exactly the given number of bits, at least 3
+template <typename Generator>
+inline BigInt random_safe_prime(size_t bits, Generator& generator) {
+    if (bits < 3) {
+        throw std::domain_error("BigInt: random_safe_prime needs at least 3 bits");
+    }
+    BigInt q = bigint_detail::random_search(bits - 1, generator, true, [](BigInt candidate) {
+        if (!candidate.is_prime()) {
+            return false;
+        }
+        BigInt p = (candidate << 1) + 1;
+        return p.is_prime();
+    });
+    return (q << 1) + 1;
+}
+
+// the same with std::random_device (the operating system's entropy source, so the primes can be used as keys)
+inline BigInt random_prime(size_t bits) {
+    std::random_device generator;
+    return random_prime(bits, generator);
+}
+
+inline BigInt random_safe_prime(size_t bits) {
+    std::random_device generator;
+    return random_safe_prime(bits, generator);
 }
 
 
@@ -0,0 +1,527 @@
+#ifndef __BIGINTBATCH_H__
+#define __BIGINTBATCH_H__
+
+#include <vector> // for the interleaved limb storage
+#include "BigInt.h" // for the limb type, scratch arena and conversions to and from BigInt
+
+
+// which kernels the batch operations run on
+enum class BatchKernel {
+    automatic,  // the widest the CPU supports (checked once, at the first batch operation)
+    generic,  // the baseline instruction set of the build (also the only choice off x86)
+    avx2,  // 4 lanes per instruction
+    avx512  // 8 lanes per instruction (AVX-512F)
+};
+
+
+// ////////// Batch Kernels ////////// //
+
+// each kernel handles one block of batch_lanes values of the same width, stored limb-interleaved: limb i
+// of lane l is at block[i * batch_lanes + l]. The loops over lanes carry nothing from one lane to the
+// next, so once a kernel is inlined into a caller compiled for AVX2 or AVX-512 the compiler turns each
+// of them into a few vector instructions. Products are taken 32 bits at a time (the widest multiply
+// vector units have), summed into 64-bit columns whose carries are resolved once at the end
+namespace bigint_detail {
+
+const size_t batch_lanes = 8;
+const limb digit_mask = 0xffffffff;  // the low 32-bit digit of a limb
+
+// zero limbs, standing in for the limbs past the end of a narrower operand
+alignas(64) const limb batch_zeros[batch_lanes] = {};
+
+// r = a + b mod 2^(64 rn) in every lane
+[[gnu::always_inline]] inline void batch_add_block(limb* __restrict r, size_t rn, const limb* __restrict a, size_t an,
+                                                   const limb* __restrict b, size_t bn) {
+    limb carry[batch_lanes] = {};
+    for (size_t i = 0; i < rn; i++) {
+        const limb* x = i < an ? a + i * batch_lanes : batch_zeros;
+        const limb* y = i < bn ? b + i * batch_lanes : batch_zeros;
+        limb* z = r + i * batch_lanes;
+        for (size_t l = 0; l < batch_lanes; l++) {
+            limb sum = x[l] + y[l];
+            limb total = sum + carry[l];
+            carry[l] = (sum < x[l]) | (total < sum);
+            z[l] = total;
+        }
+    }
+}
+
+// r = a - b mod 2^(64 rn) in every lane
+[[gnu::always_inline]] inline void batch_sub_block(limb* __restrict r, size_t rn, const limb* __restrict a, size_t an,
+                                                   const limb* __restrict b, size_t bn) {
+    limb borrow[batch_lanes] = {};
+    for (size_t i = 0; i < rn; i++) {
+        const limb* x = i < an ? a + i * batch_lanes : batch_zeros;
+        const limb* y = i < bn ? b + i * batch_lanes : batch_zeros;
+        limb* z = r + i * batch_lanes;
+        for (size_t l = 0; l < batch_lanes; l++) {
+            limb difference = x[l] - y[l];
+            limb total = difference - borrow[l];
+            borrow[l] = (x[l] < y[l]) | (difference < borrow[l]);
+            z[l] = total;
+        }
+    }
+}
+
+// splits n limbs per lane into 2n 32-bit digits per lane
+[[gnu::always_inline]] inline void batch_split_digits(limb* __restrict digits, const limb* __restrict a, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        for (size_t l = 0; l < batch_lanes; l++) {
+            limb x = a[i * batch_lanes + l];
+            digits[2 * i * batch_lanes + l] = x & digit_mask;
+            digits[(2 * i + 1) * batch_lanes + l] = x >> 32;
+        }
+    }
+}
+
+// columns[i + j] += a[i] * b[j] for 32-bit digits, split so no column can overflow: the low half of each
+// product goes into its own column and the high half into the next (only columns below `columns` are kept)
+[[gnu::always_inline]] inline void batch_accumulate_products(limb* __restrict column, size_t columns, const limb* __restrict a, size_t ad,
+                                                             const limb* __restrict b, size_t bd) {
+    for (size_t i = 0; i < ad; i++) {
+        for (size_t j = 0; j < bd && i + j < columns; j++) {
+            const limb* x = a + i * batch_lanes;
+            const limb* y = b + j * batch_lanes;
+            limb* c = column + (i + j) * batch_lanes;
+            for (size_t l = 0; l < batch_lanes; l++) {
+                limb product = (x[l] & digit_mask) * (y[l] & digit_mask);
+                c[l] += product & digit_mask;
+                c[batch_lanes + l] += product >> 32;
+            }
+        }
+    }
+}
+
+// r = a * b mod 2^(64 rn) in every lane; scratch holds (2an + 2bn + 2rn + 1) * batch_lanes limbs
+[[gnu::always_inline]] inline void batch_mul_block(limb* __restrict r, size_t rn, const limb* __restrict a, size_t an,
+                                                   const limb* __restrict b, size_t bn, limb* __restrict scratch) {
+    limb* a_digits = scratch;
+    limb* b_digits = a_digits + 2 * an * batch_lanes;
+    limb* column = b_digits + 2 * bn * batch_lanes;
+    batch_split_digits(a_digits, a, an);
+    batch_split_digits(b_digits, b, bn);
+    for (size_t k = 0; k < (2 * rn + 1) * batch_lanes; k++) {
+        column[k] = 0;
+    }
+    batch_accumulate_products(column, 2 * rn, a_digits, 2 * an, b_digits, 2 * bn);
+
+    // resolve the column carries, two digits per limb
+    limb carry[batch_lanes] = {};
+    for (size_t k = 0; k < rn; k++) {
+        for (size_t l = 0; l < batch_lanes; l++) {
+            limb low = column[2 * k * batch_lanes + l] + carry[l];
+            limb high = column[(2 * k + 1) * batch_lanes + l] + (low >> 32);
+            r[k * batch_lanes + l] = (low & digit_mask) | (high << 32);
+            carry[l] = high >> 32;
+        }
+    }
+}
+
+// r = a * b / 2^(64n) mod m in every lane (Montgomery multiplication in radix 2^32), for n-limb a, b < m
+// and an odd n-limb modulus shared by all lanes: m_digits holds its 2n digits and inverse is -1 / m mod 2^32;
+// scratch holds (8n + 1) * batch_lanes limbs
+[[gnu::always_inline]] inline void batch_montgomery_block(limb* __restrict r, const limb* __restrict a, const limb* __restrict b, size_t n,
+                                                          const limb* __restrict m_digits, limb inverse, limb* __restrict scratch) {
+    size_t d = 2 * n;
+    limb* a_digits = scratch;
+    limb* b_digits = a_digits + d * batch_lanes;
+    limb* t = b_digits + d * batch_lanes;
+    batch_split_digits(a_digits, a, n);
+    batch_split_digits(b_digits, b, n);
+    for (size_t k = 0; k < (2 * d + 1) * batch_lanes; k++) {
+        t[k] = 0;
+    }
+    batch_accumulate_products(t, 2 * d, a_digits, d, b_digits, d);
+
+    // each step adds the multiple of m that clears digit i, then moves digit i's carry up
+    for (size_t i = 0; i < d; i++) {
+        limb* ti = t + i * batch_lanes;
+        limb u[batch_lanes];
+        for (size_t l = 0; l < batch_lanes; l++) {
+            u[l] = ((ti[l] & digit_mask) * inverse) & digit_mask;
+        }
+        for (size_t j = 0; j < d; j++) {
+            limb mj = m_digits[j] & digit_mask;
+            limb* c = t + (i + j) * batch_lanes;
+            for (size_t l = 0; l < batch_lanes; l++) {
+                limb product = u[l] * mj;
+                c[l] += product & digit_mask;
+                c[batch_lanes + l] += product >> 32;
+            }
+        }
+        for (size_t l = 0; l < batch_lanes; l++) {
+            ti[batch_lanes + l] += ti[l] >> 32;
+        }
+    }
+
+    // the upper half (below 2m) as digits, then the same minus m
+    limb carry[batch_lanes] = {}, borrow[batch_lanes] = {};
+    for (size_t k = 0; k < d; k++) {
+        limb mk = m_digits[k] & digit_mask;
+        for (size_t l = 0; l < batch_lanes; l++) {
+            limb value = t[(d + k) * batch_lanes + l] + carry[l];
+            a_digits[k * batch_lanes + l] = value & digit_mask;
+            carry[l] = value >> 32;
+            limb difference = (value & digit_mask) - mk - borrow[l];
+            b_digits[k * batch_lanes + l] = difference & digit_mask;
+            borrow[l] = difference >> 63;
+        }
+    }
+
+    // keep the difference when the value was at least m (a carry out of the top, or no borrow)
+    limb keep_difference[batch_lanes];
+    for (size_t l = 0; l < batch_lanes; l++) {
+        limb top = t[2 * d * batch_lanes + l] + carry[l];
+        keep_difference[l] = (limb)0 - (limb)((top != 0) | (borrow[l] == 0));
+    }
+    for (size_t k = 0; k < n; k++) {
+        for (size_t l = 0; l < batch_lanes; l++) {
+            limb low = (b_digits[2 * k * batch_lanes + l] & keep_difference[l]) | (a_digits[2 * k * batch_lanes + l] & ~keep_difference[l]);
+            limb high = (b_digits[(2 * k + 1) * batch_lanes + l] & keep_difference[l]) | (a_digits[(2 * k + 1) * batch_lanes + l] & ~keep_difference[l]);
+            r[k * batch_lanes + l] = low | (high << 32);
+        }
+    }
+}
+
+// runs kernel(g) for every block g, with the loops compiled for the chosen instruction set
+template <typename Kernel>
+inline void batch_run_generic(const Kernel& kernel, size_t blocks) {
+    for (size_t g = 0; g < blocks; g++) {
+        kernel(g);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template <typename Kernel>
+[[gnu::target("avx2")]] inline void batch_run_avx2(const Kernel& kernel, size_t blocks) {
+    for (size_t g = 0; g < blocks; g++) {
+        kernel(g);
+    }
+}
+
+template <typename Kernel>
+[[gnu::target("avx512f")]] inline void batch_run_avx512(const Kernel& kernel, size_t blocks) {
+    for (size_t g = 0; g < blocks; g++) {
+        kernel(g);
+    }
+}
+#endif
+
+// the widest instruction set this CPU supports
+inline BatchKernel batch_supported_kernel() {
+#if defined(__x86_64__) || defined(__i386__)
+    static const BatchKernel supported = __builtin_cpu_supports("avx512f") ? BatchKernel::avx512 :
+                                         __builtin_cpu_supports("avx2") ? BatchKernel::avx2 : BatchKernel::generic;
+    return supported;
+#else
+    return BatchKernel::generic;
+#endif
+}
+
+// the requested kernels, or the widest supported ones if the CPU lacks them
+inline BatchKernel batch_kernel(BatchKernel requested) {
+    BatchKernel supported = batch_supported_kernel();
+    if (requested == BatchKernel::automatic || (int)requested > (int)supported) {
+        return supported;
+    }
+    return requested;
+}
+
+template <typename Kernel>
+inline void batch_run(BatchKernel requested, const Kernel& kernel, size_t blocks) {
+    switch (batch_kernel(requested)) {
+#if defined(__x86_64__) || defined(__i386__)
+    case BatchKernel::avx512:
+        batch_run_avx512(kernel, blocks);
+        return;
+    case BatchKernel::avx2:
+        batch_run_avx2(kernel, blocks);
+        return;
+#endif
+    default:
+        batch_run_generic(kernel, blocks);
+    }
+}
+
+}  // namespace bigint_detail
+
+
+// ////////// BigIntBatch ////////// //
+
+// many non-negative numbers of the same width (in limbs), stored limb-interleaved in blocks of
+// BigIntBatch::lanes values so the batch operations below work on a whole block per instruction
+// (ex: a million 256-bit values: BigIntBatch a(values, 4); batch_mul(a, b, products);)
+class BigIntBatch {
+public:
+    typedef bigint_detail::limb limb;
+    static constexpr size_t lanes = bigint_detail::batch_lanes;  // values per block
+    static BatchKernel kernel;  // the kernels batch operations run on (automatic by default; forcing one the CPU lacks falls back)
+
+    BigIntBatch(size_t, size_t);  // ex: BigIntBatch a(1000, 4) (a thousand 256-bit zeros)
+    BigIntBatch(const std::vector<BigInt>&, size_t);  // ex: BigIntBatch a(values, 4), throws std::out_of_range if a value is negative or wider
+    explicit BigIntBatch(const std::vector<BigInt>&);  // ex: BigIntBatch a(values) (as wide as the widest value)
+
+    size_t size() const;  // returns the number of values
+    size_t limbs() const;  // returns the width of every value, in limbs
+    size_t blocks() const;  // returns the number of blocks (the last one is padded with zeros)
+
+    BigInt get(size_t) const;  // returns value i as a BigInt
+    void set(size_t, const BigInt&);  // sets value i, throws std::out_of_range if it is negative or wider
+    std::vector<BigInt> to_vector() const;  // returns every value as a BigInt
+
+    limb* block(size_t);  // returns block g: limb i of value lanes * g + l is at block(g)[i * lanes + l]
+    const limb* block(size_t) const;
+
+private:
+    size_t count;
+    size_t width;
+    std::vector<limb> data;
+};
+
+// the batch operations: every output value is the exact result mod 2^(64 * out.limbs()), so an out one limb
+// wider than the operands keeps every sum, and one as wide as both operands together keeps every product
+inline void batch_add(const BigIntBatch& a, const BigIntBatch& b, BigIntBatch& out);  // out[i] = a[i] + b[i]
+inline void batch_sub(const BigIntBatch& a, const BigIntBatch& b, BigIntBatch& out);  // out[i] = a[i] - b[i] (wrapping around when negative)
+inline void batch_mul(const BigIntBatch& a, const BigIntBatch& b, BigIntBatch& out);  // out[i] = a[i] * b[i]
+inline void batch_mulmod(const BigIntBatch& a, const BigIntBatch& b, const BigInt& modulus, BigIntBatch& out);  // out[i] = a[i] * b[i] % modulus, for a[i], b[i] < modulus
+
+// the same on vectors of non-negative BigInts (packed, computed in full, then unpacked)
+inline std::vector<BigInt> batch_add(const std::vector<BigInt>& a, const std::vector<BigInt>& b);
+inline std::vector<BigInt> batch_mul(const std::vector<BigInt>& a, const std::vector<BigInt>& b);
+inline std::vector<BigInt> batch_mulmod(const std::vector<BigInt>& a, const std::vector<BigInt>& b, const BigInt& modulus);
+
+inline BatchKernel BigIntBatch::kernel = BatchKernel::automatic;
+
+
+// ////////// Batch Storage ////////// //
+
+inline BigIntBatch::BigIntBatch(size_t values, size_t limbs) : count(values), width(limbs),
+    data((values + lanes - 1) / lanes * lanes * limbs, 0) {
+}
+
+inline BigIntBatch::BigIntBatch(const std::vector<BigInt>& values, size_t limbs) : BigIntBatch(values.size(), limbs) {
+    for (size_t i = 0; i < values.size(); i++) {
+        set(i, values[i]);
+    }
+}
+
+inline BigIntBatch::BigIntBatch(const std::vector<BigInt>& values) : BigIntBatch(values, [&]() {
+    size_t widest = 0;
+    for (const BigInt& value : values) {
+        widest = std::max<size_t>(widest, value.size());
+    }
+    return widest;
+}()) {
+}
+
+inline size_t BigIntBatch::size() const {
+    return count;
+}
+
+inline size_t BigIntBatch::limbs() const {
+    return width;
+}
+
+inline size_t BigIntBatch::blocks() const {
+    return (count + lanes - 1) / lanes;
+}
+
+inline BigIntBatch::limb* BigIntBatch::block(size_t g) {
+    return data.data() + g * lanes * width;
+}
+
+inline const BigIntBatch::limb* BigIntBatch::block(size_t g) const {
+    return data.data() + g * lanes * width;
+}
+
+inline BigInt BigIntBatch::get(size_t i) const {
+    const limb* first = block(i / lanes) + i % lanes;
+    BigInt result;
+    result.number.resize(width);
+    for (size_t k = 0; k < width; k++) {
+        result.number[k] = first[k * lanes];
+    }
+    result.trim();
+    return result;
+}
+
+inline void BigIntBatch::set(size_t i, const BigInt& value) {
+    if (value.negative || value.size() > width) {
+        throw std::out_of_range("BigIntBatch: " + value.to_string() + " does not fit in " + std::to_string(width) + " limbs");
+    }
+    limb* first = block(i / lanes) + i % lanes;
+    for (size_t k = 0; k < width; k++) {
+        first[k * lanes] = k < value.size() ? value.number[k] : 0;
+    }
+}
+
+inline std::vector<BigInt> BigIntBatch::to_vector() const {
+    std::vector<BigInt> result(count);
+    for (size_t i = 0; i < count; i++) {
+        result[i] = get(i);
+    }
+    return result;
+}
+
+
+// ////////// Batch Operations ////////// //
+
+namespace bigint_detail {
+
+inline void batch_check_sizes(const BigIntBatch& a, const BigIntBatch& b, const BigIntBatch& out) {
+    if (a.size() != b.size() || a.size() != out.size()) {
+        throw std::invalid_argument("BigIntBatch: operands of different sizes");
+    }
+}
+
+// returns true if value i of a batch is below a positive bound
+inline bool batch_below(const BigIntBatch& batch, size_t i, const BigInt& bound) {
+    const limb* value = batch.block(i / BigIntBatch::lanes) + i % BigIntBatch::lanes;
+    for (size_t k = std::max<size_t>(batch.limbs(), bound.size()); k-- > 0; ) {
+        limb x = k < batch.limbs() ? value[k * BigIntBatch::lanes] : 0;
+        limb y = k < bound.size() ? bound.number[k] : 0;
+        if (x != y) {
+            return x < y;
+        }
+    }
+    return false;
+}
+
+// the kernels need their output apart from their operands, so when out is also an operand the operation
+// runs into a fresh batch that then replaces out; returns false (having done nothing) otherwise
+template <typename Operation>
+inline bool batch_aliased(const BigIntBatch& a, const BigIntBatch& b, BigIntBatch& out, const Operation& operation) {
+    if (&out != &a && &out != &b) {
+        return false;
+    }
+    BigIntBatch result(out.size(), out.limbs());
+    operation(result);
+    out = std::move(result);
+    return true;
+}
+
+}  // namespace bigint_detail
+
+inline void batch_add(const BigIntBatch& a, const BigIntBatch& b, BigIntBatch& out) {
+    bigint_detail::batch_check_sizes(a, b, out);
+    if (bigint_detail::batch_aliased(a, b, out, [&](BigIntBatch& result) { batch_add(a, b, result); })) {
+        return;
+    }
+    bigint_detail::batch_run(BigIntBatch::kernel, [&](size_t g) __attribute__((always_inline)) {
+        bigint_detail::batch_add_block(out.block(g), out.limbs(), a.block(g), a.limbs(), b.block(g), b.limbs());
+    }, out.blocks());
+}
+
+inline void batch_sub(const BigIntBatch& a, const BigIntBatch& b, BigIntBatch& out) {
+    bigint_detail::batch_check_sizes(a, b, out);
+    if (bigint_detail::batch_aliased(a, b, out, [&](BigIntBatch& result) { batch_sub(a, b, result); })) {
+        return;
+    }
+    bigint_detail::batch_run(BigIntBatch::kernel, [&](size_t g) __attribute__((always_inline)) {
+        bigint_detail::batch_sub_block(out.block(g), out.limbs(), a.block(g), a.limbs(), b.block(g), b.limbs());
+    }, out.blocks());
+}
+
+inline void batch_mul(const BigIntBatch& a, const BigIntBatch& b, BigIntBatch& out) {
+    bigint_detail::batch_check_sizes(a, b, out);
+    if (bigint_detail::batch_aliased(a, b, out, [&](BigIntBatch& result) { batch_mul(a, b, result); })) {
+        return;
+    }
+    bigint_detail::ScratchScope scratch;
+    bigint_detail::limb* space = scratch.allocate((2 * a.limbs() + 2 * b.limbs() + 2 * out.limbs() + 1) * BigIntBatch::lanes);
+    bigint_detail::batch_run(BigIntBatch::kernel, [&](size_t g) __attribute__((always_inline)) {
+        bigint_detail::batch_mul_block(out.block(g), out.limbs(), a.block(g), a.limbs(), b.block(g), b.limbs(), space);
+    }, out.blocks());
+}
+
+// Montgomery form with R = 2^(64n) for odd moduli: a * b / R, then times R^2 mod m / R again to undo the
+// 1 / R; even moduli fall back to BigInt arithmetic one value at a time
+inline void batch_mulmod(const BigIntBatch& a, const BigIntBatch& b, const BigInt& modulus, BigIntBatch& out) {
+    typedef bigint_detail::limb limb;
+    bigint_detail::batch_check_sizes(a, b, out);
+    if (modulus < 1) {
+        throw std::domain_error("BigIntBatch: mulmod with a non-positive modulus");
+    }
+    size_t n = modulus.size();
+    if (out.limbs() < n) {
+        throw std::invalid_argument("BigIntBatch: mulmod output narrower than the modulus");
+    }
+    if (bigint_detail::batch_aliased(a, b, out, [&](BigIntBatch& result) { batch_mulmod(a, b, modulus, result); })) {
+        return;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (!bigint_detail::batch_below(a, i, modulus) || !bigint_detail::batch_below(b, i, modulus)) {
+            throw std::domain_error("BigIntBatch: mulmod operands must be below the modulus");
+        }
+    }
+
+    if (modulus.number[0] % 2 == 0 || modulus == 1) {
+        for (size_t i = 0; i < a.size(); i++) {
+            out.set(i, lazy(a.get(i)) * b.get(i) % modulus);
+        }
+        return;
+    }
+
+    // the modulus as 32-bit digits, -1 / m mod 2^32 and R^2 mod m (broadcast to every lane)
+    std::vector<limb> m_digits(2 * n);
+    for (size_t k = 0; k < n; k++) {
+        m_digits[2 * k] = modulus.number[k] & bigint_detail::digit_mask;
+        m_digits[2 * k + 1] = modulus.number[k] >> 32;
+    }
+    limb inverse = modulus.number[0];
+    for (int i = 0; i < 5; i++) {
+        inverse *= 2 - modulus.number[0] * inverse;
+    }
+    inverse = (0 - inverse) & bigint_detail::digit_mask;
+    BigInt r_squared = (BigInt(1) << (128 * n)) % modulus;
+    std::vector<limb> r_squared_lanes(n * BigIntBatch::lanes);
+    for (size_t k = 0; k < r_squared.size(); k++) {
+        std::fill(r_squared_lanes.begin() + k * BigIntBatch::lanes, r_squared_lanes.begin() + (k + 1) * BigIntBatch::lanes, r_squared.number[k]);
+    }
+
+    // operands narrower than the modulus are widened into n-limb blocks first
+    bigint_detail::ScratchScope scratch;
+    limb* space = scratch.allocate((8 * n + 1) * BigIntBatch::lanes);
+    limb* x = scratch.allocate(n * BigIntBatch::lanes);
+    limb* y = scratch.allocate(n * BigIntBatch::lanes);
+    limb* product = scratch.allocate(n * BigIntBatch::lanes);
+    limb* reduced = scratch.allocate(n * BigIntBatch::lanes);
+    const limb* m = m_digits.data();
+    const limb* r2 = r_squared_lanes.data();
+    bigint_detail::batch_run(BigIntBatch::kernel, [&](size_t g) __attribute__((always_inline)) {
+        const limb* p = a.block(g);
+        const limb* q = b.block(g);
+        if (a.limbs() != n) {
+            bigint_detail::batch_add_block(x, n, p, std::min(a.limbs(), n), bigint_detail::batch_zeros, 0);
+            p = x;
+        }
+        if (b.limbs() != n) {
+            bigint_detail::batch_add_block(y, n, q, std::min(b.limbs(), n), bigint_detail::batch_zeros, 0);
+            q = y;
+        }
+        bigint_detail::batch_montgomery_block(product, p, q, n, m, inverse, space);
+        bigint_detail::batch_montgomery_block(reduced, product, r2, n, m, inverse, space);
+        bigint_detail::batch_add_block(out.block(g), out.limbs(), reduced, n, bigint_detail::batch_zeros, 0);
+    }, out.blocks());
+}
+
+inline std::vector<BigInt> batch_add(const std::vector<BigInt>& a, const std::vector<BigInt>& b) {
+    BigIntBatch x(a), y(b), sum(a.size(), std::max(x.limbs(), y.limbs()) + 1);
+    batch_add(x, y, sum);
+    return sum.to_vector();
+}
+
+inline std::vector<BigInt> batch_mul(const std::vector<BigInt>& a, const std::vector<BigInt>& b) {
+    BigIntBatch x(a), y(b), product(a.size(), x.limbs() + y.limbs());
+    batch_mul(x, y, product);
+    return product.to_vector();
+}
+
+inline std::vector<BigInt> batch_mulmod(const std::vector<BigInt>& a, const std::vector<BigInt>& b, const BigInt& modulus) {
+    BigIntBatch x(a, modulus.size()), y(b, modulus.size()), result(a.size(), modulus.size());
+    batch_mulmod(x, y, modulus, result);
+    return result.to_vector();
+}
+
+
+#endif
@@ -0,0 +1,476 @@
+#ifndef __BIGINTIO_H__
+#define __BIGINTIO_H__
+
+#include <istream> // for reading from streams
+#include <ostream> // for writing to streams
+#include <fstream> // for the fallback when files can't be memory-mapped
+#include <cstring> // for std::memcpy and std::memmove on the buffers
+#include "BigInt.h" // for the decimal and framed conversions
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h> // for open
+#include <sys/mman.h> // for mmap
+#include <sys/stat.h> // for fstat, the size of the file
+#include <unistd.h> // for close
+#endif
+
+
+// the formats the readers and writers handle
+enum class BigIntFormat {
+    decimal,  // whitespace-separated decimal numbers (an optional sign, then digits); written one per line
+    framed  // back-to-back frames, as written by to_framed / BigInt::write_framed
+};
+
+
+// ////////// Streaming Conversion ////////// //
+
+// numbers of any length go through fixed-size pieces of text: parsing turns every 19 * 2^12 (77824) digits
+// into a BigInt as soon as they have arrived and merges equal-length pieces like a binary counter
+// (high * 10^(digits of low) + low, with the power from the cached decimal_power tree), and formatting splits
+// the number by those powers until each piece fits the buffer, so a number's text is never held in full
+namespace bigint_detail {
+
+const size_t decimal_stream_level = 12;  // the decimal_power level of one piece
+const size_t decimal_stream_digits = (size_t)decimal_base_digits << decimal_stream_level;  // digits per piece
+
+// collects the digits of one decimal number as they arrive, holding less than one piece of text at a time
+class DecimalAccumulator {
+public:
+    void append(const char* digits, size_t n);  // digits that follow the ones appended before (already validated)
+    BigInt finish(bool negative);  // returns the number, and starts over
+
+private:
+    std::string pending;  // digits not yet converted (less than a piece)
+    std::vector<std::pair<BigInt, size_t>> pieces;  // converted pieces and how many pieces of digits each holds, most significant first
+};
+
+inline void DecimalAccumulator::append(const char* digits, size_t n) {
+    while (n > 0) {
+        size_t take = std::min(n, decimal_stream_digits - pending.size());
+        pending.append(digits, take);
+        digits += take;
+        n -= take;
+        if (pending.size() < decimal_stream_digits) {
+            break;
+        }
+
+        pieces.emplace_back(parse_decimal(pending.data(), pending.size()), 1);
+        pending.clear();
+        while (pieces.size() >= 2 && pieces[pieces.size() - 2].second == pieces.back().second) {
+            size_t count = pieces.back().second, level = decimal_stream_level;
+            while (((size_t)1 << (level - decimal_stream_level)) < count) {
+                level++;
+            }
+            std::pair<BigInt, size_t> low = std::move(pieces.back());
+            pieces.pop_back();
+            pieces.back().first = lazy(pieces.back().first) * decimal_power(level) + low.first;
+            pieces.back().second += count;
+        }
+    }
+}
+
+// the pieces are joined from the least significant up, with the running power of ten built from the same cached powers
+inline BigInt DecimalAccumulator::finish(bool negative) {
+    BigInt result = parse_decimal(pending.data(), pending.size());
+    BigInt power = BigInt(10).pow(pending.size());
+    for (size_t i = pieces.size(); i-- > 0; ) {
+        result = lazy(pieces[i].first) * power + result;
+        if (i > 0) {
+            size_t level = decimal_stream_level;
+            while (((size_t)1 << (level - decimal_stream_level)) < pieces[i].second) {
+                level++;
+            }
+            power *= decimal_power(level);
+        }
+    }
+    pending.clear();
+    pieces.clear();
+    result.negative = negative && result.size() > 0;
+    return result;
+}
+
+// writes the digits of a non-negative x < 10^(19 * 2^level) to a stream like write_decimal does into memory,
+// splitting by the middle power until a piece fits the buffer (of decimal_stream_digits chars)
+inline void stream_digits(std::ostream& os, const BigInt& x, size_t level, bool pad, char* buffer) {
+    if (level > decimal_stream_level) {
+        const BigInt& half = decimal_power(level - 1);
+        if (!pad && x < half) {
+            stream_digits(os, x, level - 1, false, buffer);
+            return;
+        }
+        BigInt high, low;
+        divmod_magnitude(x, half, high, low);
+        stream_digits(os, high, level - 1, pad, buffer);
+        stream_digits(os, low, level - 1, true, buffer);
+        return;
+    }
+    char* end = write_decimal(x, level, buffer, pad);
+    os.write(buffer, end - buffer);
+}
+
+// the bytes a number's decimal text can take, sign included
+inline size_t decimal_size_bound(const BigInt& x) {
+    return x.negative + x.size() * 20 + 1;
+}
+
+// the level write_decimal starts from (as in BigInt::to_string)
+inline size_t decimal_level(const BigInt& magnitude) {
+    size_t level = 0;
+    if (magnitude.size() >= BigInt::decimal_conversion_threshold) {
+        while (decimal_power(level) <= magnitude) {
+            level++;
+        }
+    }
+    return level;
+}
+
+// reads numbers out of a window of bytes [position, end) that refill() moves forward through the input;
+// a number inside the window is parsed in place, and one that runs past it is collected piece by piece
+class NumberScanner {
+public:
+    virtual ~NumberScanner() = default;
+
+protected:
+    bool next_decimal(BigInt&);
+    bool next_framed(BigInt&);
+
+    // makes more input available, keeping the unread bytes [position, end) at the front of the window;
+    // returns false at the end of the input (or with the window full), and sets input_done once the window
+    // holds everything that is left
+    virtual bool refill() = 0;
+
+    const char* position = nullptr;
+    const char* end = nullptr;
+    bool input_done = false;
+
+private:
+    DecimalAccumulator accumulator;
+};
+
+inline bool is_decimal_space(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool NumberScanner::next_decimal(BigInt& value) {
+    // whitespace, then an optional sign
+    while (true) {
+        while (position < end && is_decimal_space(*position)) {
+            position++;
+        }
+        if (position < end) {
+            break;
+        }
+        if (!refill()) {
+            return false;
+        }
+    }
+    bool negative = *position == '-';
+    if (*position == '-' || *position == '+') {
+        position++;
+    }
+
+    // digits up to whitespace or the end of the input; while they run to the end of the window, they are collected
+    size_t count = 0;
+    bool collecting = false;
+    while (true) {
+        if (position == end && !refill()) {
+            break;
+        }
+        const char* digits = position;
+        while (position < end && *position >= '0' && *position <= '9') {
+            position++;
+        }
+        count += position - digits;
+        if (position < end) {
+            if (!is_decimal_space(*position)) {
+                throw std::invalid_argument(std::string("BigInt: invalid character '") + *position + "' in a decimal number");
+            }
+            if (count == 0) {
+                throw std::invalid_argument("BigInt: a sign without digits");
+            }
+            if (!collecting) {
+                value = parse_decimal(digits, position - digits);
+                value.negative = negative && value.size() > 0;
+                return true;
+            }
+        }
+        accumulator.append(digits, position - digits);
+        collecting = true;
+        if (position < end) {
+            break;
+        }
+    }
+    if (count == 0) {
+        throw std::invalid_argument("BigInt: a sign without digits");
+    }
+    value = accumulator.finish(negative);
+    return true;
+}
+
+inline bool NumberScanner::next_framed(BigInt& value) {
+    // the header (at most 10 bytes) is made contiguous first
+    while ((size_t)(end - position) < 10 && refill()) {
+    }
+    if (position == end) {
+        return false;
+    }
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(position);
+    const uint8_t* limit = reinterpret_cast<const uint8_t*>(end);
+    uint64_t header;
+    const uint8_t* body = read_varint(bytes, limit, header);
+    uint64_t length = header >> 1;
+    position = reinterpret_cast<const char*>(body);
+
+    // the length comes from the data: once the rest of the input is known, a frame longer than it fails before
+    // anything is allocated, and until then the limbs only grow as the bytes actually arrive
+    if (input_done && length > (uint64_t)(end - position)) {
+        throw std::invalid_argument("BigInt: framed number runs past the end of the data");
+    }
+
+    // the magnitude, copied straight into the limbs (bytes in memory order, fixed up on big-endian hosts)
+    value.number.clear();
+    for (uint64_t copied = 0; copied < length; ) {
+        if (position == end && !refill()) {
+            throw std::invalid_argument("BigInt: framed number runs past the end of the data");
+        }
+        size_t take = (size_t)std::min<uint64_t>(length - copied, end - position);
+        value.number.resize((copied + take + sizeof(limb) - 1) / sizeof(limb), 0);
+        std::memcpy(reinterpret_cast<uint8_t*>(value.number.data()) + copied, position, take);
+        position += take;
+        copied += take;
+    }
+    for (limb& l : value.number) {
+        l = load_little_endian(reinterpret_cast<const uint8_t*>(&l));
+    }
+    value.negative = header & 1;
+    value.trim();
+    return true;
+}
+
+}  // namespace bigint_detail
+
+
+// ////////// Readers ////////// //
+
+// reads BigInts one at a time from a stream through a fixed-size buffer, so a file of any size (or a single
+// number of any length) is read with bounded memory beyond the numbers themselves
+// (ex: BigIntReader reader(file); BigInt x; while (reader.next(x)) { ... })
+class BigIntReader : public bigint_detail::NumberScanner {
+public:
+    explicit BigIntReader(std::istream&, BigIntFormat = BigIntFormat::decimal, size_t = 1 << 16);  // ex: BigIntReader reader(std::cin)
+    bool next(BigInt&);  // reads the next number, returns false at the end (throws std::invalid_argument on malformed input)
+
+private:
+    bool refill() override;
+
+    std::istream& input;
+    BigIntFormat format;
+    std::vector<char> buffer;
+};
+
+// reads BigInts one at a time from a file mapped into memory: nothing is copied up front, pages are read in as
+// the numbers are reached, and a number is parsed straight from the mapping
+// (ex: MappedBigIntReader reader("numbers.txt"); BigInt x; while (reader.next(x)) { ... })
+class MappedBigIntReader : public bigint_detail::NumberScanner {
+public:
+    explicit MappedBigIntReader(const std::string&, BigIntFormat = BigIntFormat::decimal);  // throws std::runtime_error if the file can't be read
+    ~MappedBigIntReader();
+    MappedBigIntReader(const MappedBigIntReader&) = delete;
+    MappedBigIntReader& operator=(const MappedBigIntReader&) = delete;
+
+    bool next(BigInt&);  // reads the next number, returns false at the end (throws std::invalid_argument on malformed input)
+    size_t size() const;  // returns the size of the file in bytes
+
+private:
+    bool refill() override;
+
+    BigIntFormat format;
+    const char* data = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    std::vector<char> copy;  // the file's contents where it can't be mapped
+};
+
+inline BigIntReader::BigIntReader(std::istream& is, BigIntFormat format, size_t buffer_size)
+    : input(is), format(format), buffer(std::max<size_t>(buffer_size, 16)) {
+    position = end = buffer.data();
+}
+
+inline bool BigIntReader::next(BigInt& value) {
+    return format == BigIntFormat::decimal ? next_decimal(value) : next_framed(value);
+}
+
+inline bool BigIntReader::refill() {
+    size_t kept = end - position;
+    if (kept == buffer.size() || !input) {
+        return false;
+    }
+    std::memmove(buffer.data(), position, kept);
+    input.read(buffer.data() + kept, buffer.size() - kept);
+    position = buffer.data();
+    end = buffer.data() + kept + input.gcount();
+    input_done = !input;
+    return input.gcount() > 0;
+}
+
+inline MappedBigIntReader::MappedBigIntReader(const std::string& path, BigIntFormat format) : format(format) {
+#if defined(__unix__) || defined(__APPLE__)
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::runtime_error("BigInt: can't open " + path);
+    }
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0) {
+        ::close(descriptor);
+        throw std::runtime_error("BigInt: can't read the size of " + path);
+    }
+    length = (size_t)status.st_size;
+    if (length > 0) {
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (address != MAP_FAILED) {
+            data = static_cast<const char*>(address);
+            mapped = true;
+            ::madvise(address, length, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(descriptor);
+#endif
+    if (!mapped && (length > 0 || data == nullptr)) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("BigInt: can't open " + path);
+        }
+        copy.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data = copy.data();
+        length = copy.size();
+    }
+    position = data;
+    end = data + length;
+    input_done = true;
+}
+
+inline MappedBigIntReader::~MappedBigIntReader() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapped) {
+        ::munmap(const_cast<char*>(data), length);
+    }
+#endif
+}
+
+inline bool MappedBigIntReader::next(BigInt& value) {
+    return format == BigIntFormat::decimal ? next_decimal(value) : next_framed(value);
+}
+
+inline size_t MappedBigIntReader::size() const {
+    return length;
+}
+
+inline bool MappedBigIntReader::refill() {
+    return false;  // the whole file is in the window already
+}
+
+
+// ////////// Writers ////////// //
+
+// writes BigInts to a stream through a buffer, handing it to the stream in large batches; a number too long for
+// the buffer is formatted a piece at a time instead of as one string (ex: BigIntWriter out(file); out.write(x);)
+class BigIntWriter {
+public:
+    explicit BigIntWriter(std::ostream&, BigIntFormat = BigIntFormat::decimal, size_t = 1 << 20);  // ex: BigIntWriter out(std::cout)
+    ~BigIntWriter();  // flushes
+    BigIntWriter(const BigIntWriter&) = delete;
+    BigIntWriter& operator=(const BigIntWriter&) = delete;
+
+    void write(const BigInt&);  // ex: out.write(x) (decimal numbers end with a newline)
+    void write(const std::vector<BigInt>&);  // ex: out.write(values)
+    void flush();  // hands everything buffered to the stream
+
+private:
+    std::ostream& output;
+    BigIntFormat format;
+    std::vector<char> buffer;
+    size_t used = 0;
+};
+
+// writes a number in decimal to a stream without ever holding its whole text (ex: stream_decimal(file, x))
+inline void stream_decimal(std::ostream& os, const BigInt& x) {
+    if (x.size() == 0) {
+        os.put('0');
+        return;
+    }
+    if (x.negative) {
+        os.put('-');
+    }
+    BigInt magnitude = x;
+    magnitude.negative = false;
+    std::vector<char> buffer(std::min(bigint_detail::decimal_size_bound(magnitude), bigint_detail::decimal_stream_digits));
+    bigint_detail::stream_digits(os, magnitude, bigint_detail::decimal_level(magnitude), false, buffer.data());
+}
+
+inline BigIntWriter::BigIntWriter(std::ostream& os, BigIntFormat format, size_t buffer_size)
+    : output(os), format(format), buffer(std::max<size_t>(buffer_size, 64)) {
+}
+
+inline BigIntWriter::~BigIntWriter() {
+    flush();
+}
+
+inline void BigIntWriter::flush() {
+    output.write(buffer.data(), used);
+    used = 0;
+}
+
+inline void BigIntWriter::write(const BigInt& x) {
+    size_t bound = format == BigIntFormat::decimal ? bigint_detail::decimal_size_bound(x) + 1 : x.framed_size();
+    if (used + bound > buffer.size()) {
+        flush();
+    }
+    if (bound <= buffer.size()) {
+        char* out = buffer.data() + used;
+        if (format == BigIntFormat::framed) {
+            out = reinterpret_cast<char*>(x.write_framed(reinterpret_cast<uint8_t*>(out)));
+        }
+        else if (x.size() == 0) {
+            *out++ = '0';
+        }
+        else {
+            if (x.negative) {
+                *out++ = '-';
+            }
+            BigInt magnitude = x;
+            magnitude.negative = false;
+            out = bigint_detail::write_decimal(magnitude, bigint_detail::decimal_level(magnitude), out, false);
+        }
+        if (format == BigIntFormat::decimal) {
+            *out++ = '\n';
+        }
+        used = out - buffer.data();
+        return;
+    }
+
+    // too long for the buffer: straight to the stream, a piece at a time
+    if (format == BigIntFormat::decimal) {
+        stream_decimal(output, x);
+        output.put('\n');
+        return;
+    }
+    size_t length = x.byte_length();
+    uint8_t header[10];
+    output.write(reinterpret_cast<char*>(header), bigint_detail::write_varint(header, ((uint64_t)length << 1) | x.negative) - header);
+    size_t step = buffer.size() / sizeof(bigint_detail::limb) * sizeof(bigint_detail::limb);
+    for (size_t offset = 0; offset < length; offset += step) {
+        size_t take = std::min(step, length - offset);
+        bigint_detail::limbs_to_bytes(reinterpret_cast<uint8_t*>(buffer.data()), take, x.number.data() + offset / sizeof(bigint_detail::limb),
+                                      x.size() - offset / sizeof(bigint_detail::limb));
+        output.write(buffer.data(), take);
+    }
+}
+
+inline void BigIntWriter::write(const std::vector<BigInt>& values) {
+    for (const BigInt& value : values) {
+        write(value);
+    }
+}
+
+
+#endif
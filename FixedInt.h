@@ -0,0 +1,608 @@
+#ifndef __FIXEDINT_H__
+#define __FIXEDINT_H__
+
+#include <array> // the limbs of a FixedInt live in a std::array, never on the heap
+#include <type_traits> // for accepting any built-in integer type
+#include "BigInt.h" // for the shared limb kernels, and conversions to and from BigInt
+
+
+// ////////// Fixed-Width Kernels ////////// //
+
+// the BigInt kernels applied to std::arrays whose length is known at compile time, with the working space
+// on the stack; everything here is constexpr, so FixedInt arithmetic can run inside constant expressions
+namespace bigint_detail {
+
+// q = a / b and r = a % b for b != 0
+template <size_t M, size_t N>
+constexpr void fixed_divrem(std::array<limb, M>& q, std::array<limb, N>& r, const std::array<limb, M>& a, const std::array<limb, N>& b) {
+    size_t an = significant_limbs(a.data(), M), bn = significant_limbs(b.data(), N);
+    q = std::array<limb, M>{};
+    r = std::array<limb, N>{};
+    if (an < bn) {
+        for (size_t i = 0; i < an; i++) {
+            r[i] = a[i];
+        }
+        return;
+    }
+    if (bn == 1) {
+        r[0] = divrem_1(q.data(), a.data(), an, b[0]);
+        return;
+    }
+
+    std::array<limb, N> divisor{};
+    std::array<limb, M + 1> remainder{};
+    divrem_knuth(q.data(), r.data(), a.data(), an, b.data(), bn, divisor.data(), remainder.data());
+}
+
+// a mod m for a double-width a (ex: a product of two values below m)
+template <size_t N>
+constexpr std::array<limb, N> fixed_reduce(const std::array<limb, 2 * N>& a, const std::array<limb, N>& m) {
+    std::array<limb, 2 * N> q{};
+    std::array<limb, N> r{};
+    fixed_divrem(q, r, a, m);
+    return r;
+}
+
+// t / 2^(64N) mod m for an odd m and t < m * 2^(64N) (Montgomery reduction); inverse is -1 / m mod 2^64
+template <size_t N>
+constexpr std::array<limb, N> fixed_montgomery_reduce(std::array<limb, 2 * N>& t, const std::array<limb, N>& m, limb inverse) {
+    // each step clears t[i]; the carry out of t[i+N-1] is parked in t[i] and added back at the end
+    for (size_t i = 0; i < N; i++) {
+        t[i] = addmul_1(t.data() + i, m.data(), N, t[i] * inverse);
+    }
+    limb carry = add(t.data() + N, t.data() + N, N, t.data(), N);
+
+    // the upper half is now below 2m: subtract m once if needed
+    std::array<limb, N> result{};
+    for (size_t i = 0; i < N; i++) {
+        result[i] = t[N + i];
+    }
+    if (carry != 0 || cmp(result.data(), N, m.data(), N) >= 0) {
+        sub(result.data(), result.data(), N, m.data(), N);
+    }
+    return result;
+}
+
+// base^exponent with fixed 4-bit windows, where multiply(x, y) and square(x) are the products in whatever
+// representation base and one are in (ex: Montgomery form)
+template <size_t N, typename Multiply, typename Square>
+constexpr std::array<limb, N> fixed_window_pow(const std::array<limb, N>& base, const std::array<limb, N>& exponent,
+                                               const std::array<limb, N>& one, Multiply multiply, Square square) {
+    std::array<std::array<limb, N>, 16> table{};
+    table[0] = one;
+    table[1] = base;
+    for (size_t i = 2; i < 16; i++) {
+        table[i] = multiply(table[i - 1], base);
+    }
+
+    std::array<limb, N> result = one;
+    size_t length = significant_limbs(exponent.data(), N);
+    for (size_t w = 16 * length; w-- > 0; ) {  // 16 windows per limb, from the top
+        if (w + 1 < 16 * length) {
+            for (int j = 0; j < 4; j++) {
+                result = square(result);
+            }
+        }
+        limb value = (exponent[w / 16] >> (4 * (w % 16))) & 15;
+        if (value != 0) {
+            result = multiply(result, table[value]);
+        }
+    }
+    return result;
+}
+
+}  // namespace bigint_detail
+
+
+// ////////// FixedInt ////////// //
+
+// an integer of exactly Bits bits (a multiple of 64) held in a std::array on the stack: arithmetic wraps
+// around mod 2^Bits like the built-in unsigned types, and Signed values are two's complement. Loop bounds
+// are compile-time constants, and every operation except the BigInt and string conversions is constexpr
+// (ex: FixedUInt<256> for hashes, FixedUInt<2048> for RSA moduli)
+template <size_t Bits, bool Signed>
+class BasicFixedInt {
+    static_assert(Bits > 0 && Bits % 64 == 0, "FixedInt widths are whole 64-bit limbs");
+
+public:
+    typedef bigint_detail::limb limb;
+    static constexpr size_t limb_count = Bits / 64;
+    typedef std::array<limb, limb_count> Limbs;
+
+    Limbs limbs{};  // the value mod 2^Bits, least significant limb first (two's complement when Signed)
+
+    constexpr BasicFixedInt() = default;  // ex: FixedUInt<256> a (zero)
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    constexpr BasicFixedInt(T);  // ex: FixedInt<256> a = -135 (sign-extended; wraps around in a FixedUInt)
+    explicit BasicFixedInt(const BigInt&);  // ex: FixedUInt<256> a(someBigInt), throws std::out_of_range if it does not fit
+    explicit BasicFixedInt(const char*);  // ex: FixedUInt<256> a("135"), same
+    template <size_t N>
+    constexpr BasicFixedInt(const BigIntConstant<N>&);  // ex: constexpr FixedUInt<256> p = 0xffff_big (fails to compile if it does not fit)
+
+    BigInt to_bigint() const;  // returns this value as a BigInt (always exact)
+    std::string to_string() const;  // returns this value in decimal
+
+    constexpr bool is_negative() const;  // always false for a FixedUInt
+    constexpr bool is_zero() const;
+    constexpr Limbs magnitude() const;  // returns the absolute value as unsigned limbs (exact even for the most negative value)
+    constexpr size_t bit_length() const;  // returns the number of bits in the magnitude (0 for 0)
+    constexpr bool test_bit(size_t) const;  // returns bit i of the stored (two's complement) limbs
+
+    constexpr BasicFixedInt operator-() const;  // negation, mod 2^Bits
+    constexpr BasicFixedInt operator~() const;  // bitwise complement
+
+    constexpr BasicFixedInt& operator+=(const BasicFixedInt&);  // ex: a += 5
+    constexpr BasicFixedInt& operator-=(const BasicFixedInt&);  // ex: a -= 5
+    constexpr BasicFixedInt& operator*=(const BasicFixedInt&);  // ex: a *= 5 (only the low Bits of the product are computed)
+    constexpr BasicFixedInt& operator/=(const BasicFixedInt&);  // ex: a /= 5 (rounds toward zero, like BigInt)
+    constexpr BasicFixedInt& operator%=(const BasicFixedInt&);  // ex: a %= 5 (takes the sign of the dividend, like BigInt)
+    constexpr BasicFixedInt& operator<<=(size_t);  // ex: a <<= 3
+    constexpr BasicFixedInt& operator>>=(size_t);  // ex: a >>= 3 (arithmetic when Signed: rounds down, like BigInt)
+
+    constexpr BasicFixedInt& operator++();  // prefix increment
+    constexpr BasicFixedInt operator++(int);  // postfix increment
+    constexpr BasicFixedInt& operator--();  // prefix decrement
+    constexpr BasicFixedInt operator--(int);  // postfix decrement
+
+    constexpr BasicFixedInt mod_pow(const BasicFixedInt&, const BasicFixedInt&) const;  // returns this^exponent mod modulus, in [0, modulus)
+    constexpr BasicFixedInt gcd(const BasicFixedInt&) const;  // returns the greatest common divisor (non-negative)
+    constexpr BasicFixedInt mod_inverse(const BasicFixedInt&) const;  // returns the modular inverse in [0, modulus), throws std::domain_error if there is none
+
+    static constexpr int compare(const BasicFixedInt&, const BasicFixedInt&);  // returns -1, 0 or 1
+    static constexpr void divmod(const BasicFixedInt&, const BasicFixedInt&, BasicFixedInt&, BasicFixedInt&);  // quotient and remainder from one division
+
+    // the binary operators are friends so either side may be a built-in integer (ex: 5 + a)
+    friend constexpr BasicFixedInt operator+(BasicFixedInt lhs, const BasicFixedInt& rhs) { return lhs += rhs; }
+    friend constexpr BasicFixedInt operator-(BasicFixedInt lhs, const BasicFixedInt& rhs) { return lhs -= rhs; }
+    friend constexpr BasicFixedInt operator*(BasicFixedInt lhs, const BasicFixedInt& rhs) { return lhs *= rhs; }
+    friend constexpr BasicFixedInt operator/(BasicFixedInt lhs, const BasicFixedInt& rhs) { return lhs /= rhs; }
+    friend constexpr BasicFixedInt operator%(BasicFixedInt lhs, const BasicFixedInt& rhs) { return lhs %= rhs; }
+    friend constexpr BasicFixedInt operator<<(BasicFixedInt lhs, size_t shift) { return lhs <<= shift; }
+    friend constexpr BasicFixedInt operator>>(BasicFixedInt lhs, size_t shift) { return lhs >>= shift; }
+
+    friend constexpr bool operator==(const BasicFixedInt& lhs, const BasicFixedInt& rhs) { return compare(lhs, rhs) == 0; }
+    friend constexpr bool operator!=(const BasicFixedInt& lhs, const BasicFixedInt& rhs) { return compare(lhs, rhs) != 0; }
+    friend constexpr bool operator<(const BasicFixedInt& lhs, const BasicFixedInt& rhs) { return compare(lhs, rhs) < 0; }
+    friend constexpr bool operator>(const BasicFixedInt& lhs, const BasicFixedInt& rhs) { return compare(lhs, rhs) > 0; }
+    friend constexpr bool operator<=(const BasicFixedInt& lhs, const BasicFixedInt& rhs) { return compare(lhs, rhs) <= 0; }
+    friend constexpr bool operator>=(const BasicFixedInt& lhs, const BasicFixedInt& rhs) { return compare(lhs, rhs) >= 0; }
+
+private:
+    static constexpr BasicFixedInt from_magnitude(const Limbs&, bool);  // applies a sign to an unsigned magnitude
+};
+
+template <size_t Bits> using FixedInt = BasicFixedInt<Bits, true>;  // signed, two's complement
+template <size_t Bits> using FixedUInt = BasicFixedInt<Bits, false>;  // unsigned
+
+template <size_t Bits, bool Signed>
+inline std::pair<BasicFixedInt<Bits, Signed>, BasicFixedInt<Bits, Signed>> divmod(const BasicFixedInt<Bits, Signed>& a, const BasicFixedInt<Bits, Signed>& b);
+template <size_t Bits, bool Signed>
+inline std::ostream& operator<<(std::ostream& out, const BasicFixedInt<Bits, Signed>& x);
+
+
+// ////////// FixedInt Conversions ////////// //
+
+// initialization to a built-in integer, sign-extended to the full width
+template <size_t Bits, bool Signed>
+template <typename T, typename>
+constexpr BasicFixedInt<Bits, Signed>::BasicFixedInt(T value) {
+    limbs[0] = (limb)value;
+    size_t extended = 1;
+    if constexpr (sizeof(T) > sizeof(limb) && limb_count > 1) {
+        limbs[1] = (limb)((unsigned __int128)value >> 64);  // a FixedInt<64> keeps only the low limb, wrapping around
+        extended = 2;
+    }
+    bool negative = false;
+    if constexpr (std::is_signed<T>::value) {
+        negative = value < 0;
+    }
+    for (size_t i = extended; i < limb_count; i++) {
+        limbs[i] = negative ? ~(limb)0 : 0;
+    }
+}
+
+// initialization to a BigInt, which must be representable exactly
+template <size_t Bits, bool Signed>
+BasicFixedInt<Bits, Signed>::BasicFixedInt(const BigInt& value) {
+    bool fits = value.size() <= limb_count && !(value.negative && !Signed);
+    if (fits && Signed && value.size() == limb_count && value.number[limb_count - 1] >> 63) {
+        // only -2^(Bits-1) has the top bit set in its magnitude
+        fits = value.negative && value.number[limb_count - 1] == (limb)1 << 63 &&
+               bigint_detail::significant_limbs(value.number.data(), limb_count - 1) == 0;
+    }
+    if (!fits) {
+        throw std::out_of_range("FixedInt: " + value.to_string() + " does not fit in " + std::to_string(Bits) + " bits");
+    }
+
+    Limbs magnitude{};
+    std::copy(value.number.begin(), value.number.end(), magnitude.begin());
+    *this = from_magnitude(magnitude, value.negative);
+}
+
+// initialization to a compile-time constant, which must be representable exactly
+template <size_t Bits, bool Signed>
+template <size_t N>
+constexpr BasicFixedInt<Bits, Signed>::BasicFixedInt(const BigIntConstant<N>& value) {
+    static_assert(N <= limb_count, "FixedInt: the constant does not fit in this width");
+    Limbs magnitude{};
+    for (size_t i = 0; i < N; i++) {
+        magnitude[i] = value.limbs[i];
+    }
+    bool fits = !(value.negative && !Signed);
+    if (Signed && N == limb_count && magnitude[limb_count - 1] >> 63) {
+        // only -2^(Bits-1) has the top bit set in its magnitude
+        fits = value.negative && magnitude[limb_count - 1] == (limb)1 << 63 &&
+               bigint_detail::significant_limbs(magnitude.data(), limb_count - 1) == 0;
+    }
+    if (!fits) {
+        throw std::out_of_range("FixedInt: the constant does not fit");
+    }
+    *this = from_magnitude(magnitude, value.negative);
+}
+
+// initialization to a decimal string (through BigInt)
+template <size_t Bits, bool Signed>
+BasicFixedInt<Bits, Signed>::BasicFixedInt(const char* value) : BasicFixedInt(BigInt(value)) {
+}
+
+template <size_t Bits, bool Signed>
+BigInt BasicFixedInt<Bits, Signed>::to_bigint() const {
+    Limbs digits = magnitude();
+    BigInt result;
+    result.number.assign(digits.begin(), digits.end());
+    result.negative = is_negative();
+    result.trim();
+    return result;
+}
+
+template <size_t Bits, bool Signed>
+std::string BasicFixedInt<Bits, Signed>::to_string() const {
+    return to_bigint().to_string();
+}
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed> BasicFixedInt<Bits, Signed>::from_magnitude(const Limbs& magnitude, bool negative) {
+    BasicFixedInt result;
+    result.limbs = magnitude;
+    return negative ? -result : result;
+}
+
+
+// ////////// FixedInt Queries ////////// //
+
+template <size_t Bits, bool Signed>
+constexpr bool BasicFixedInt<Bits, Signed>::is_negative() const {
+    return Signed && limbs[limb_count - 1] >> 63;
+}
+
+template <size_t Bits, bool Signed>
+constexpr bool BasicFixedInt<Bits, Signed>::is_zero() const {
+    return bigint_detail::significant_limbs(limbs.data(), limb_count) == 0;
+}
+
+template <size_t Bits, bool Signed>
+constexpr typename BasicFixedInt<Bits, Signed>::Limbs BasicFixedInt<Bits, Signed>::magnitude() const {
+    return is_negative() ? (-*this).limbs : limbs;
+}
+
+template <size_t Bits, bool Signed>
+constexpr size_t BasicFixedInt<Bits, Signed>::bit_length() const {
+    Limbs digits = magnitude();
+    size_t n = bigint_detail::significant_limbs(digits.data(), limb_count);
+    return n == 0 ? 0 : 64 * n - __builtin_clzll(digits[n - 1]);
+}
+
+template <size_t Bits, bool Signed>
+constexpr bool BasicFixedInt<Bits, Signed>::test_bit(size_t i) const {
+    return i < Bits && (limbs[i / 64] >> (i % 64)) & 1;
+}
+
+// two's complement order: the sign first (when Signed), then the limbs from the top like unsigned numbers
+template <size_t Bits, bool Signed>
+constexpr int BasicFixedInt<Bits, Signed>::compare(const BasicFixedInt& lhs, const BasicFixedInt& rhs) {
+    if (lhs.is_negative() != rhs.is_negative()) {
+        return lhs.is_negative() ? -1 : 1;
+    }
+    return bigint_detail::cmp(lhs.limbs.data(), limb_count, rhs.limbs.data(), limb_count);
+}
+
+
+// ////////// FixedInt Arithmetic ////////// //
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed> BasicFixedInt<Bits, Signed>::operator~() const {
+    BasicFixedInt result;
+    for (size_t i = 0; i < limb_count; i++) {
+        result.limbs[i] = ~limbs[i];
+    }
+    return result;
+}
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed> BasicFixedInt<Bits, Signed>::operator-() const {
+    BasicFixedInt result = ~*this;
+    bigint_detail::add_1(result.limbs.data(), result.limbs.data(), limb_count, 1);
+    return result;
+}
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed>& BasicFixedInt<Bits, Signed>::operator+=(const BasicFixedInt& rhs) {
+    bigint_detail::add(limbs.data(), limbs.data(), limb_count, rhs.limbs.data(), limb_count);
+    return *this;
+}
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed>& BasicFixedInt<Bits, Signed>::operator-=(const BasicFixedInt& rhs) {
+    bigint_detail::sub(limbs.data(), limbs.data(), limb_count, rhs.limbs.data(), limb_count);
+    return *this;
+}
+
+// the low half of the elementary product, which is the same for signed and unsigned operands
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed>& BasicFixedInt<Bits, Signed>::operator*=(const BasicFixedInt& rhs) {
+    Limbs product{};
+    for (size_t i = 0; i < limb_count; i++) {
+        bigint_detail::addmul_1(product.data() + i, rhs.limbs.data(), limb_count - i, limbs[i]);
+    }
+    limbs = product;
+    return *this;
+}
+
+// divides the magnitudes, then signs the results like BigInt: the quotient rounds toward zero and the
+// remainder takes the dividend's sign
+template <size_t Bits, bool Signed>
+constexpr void BasicFixedInt<Bits, Signed>::divmod(const BasicFixedInt& a, const BasicFixedInt& b, BasicFixedInt& quotient, BasicFixedInt& remainder) {
+    if (b.is_zero()) {
+        throw std::domain_error("FixedInt: division by zero");
+    }
+    Limbs q{}, r{};
+    bigint_detail::fixed_divrem(q, r, a.magnitude(), b.magnitude());
+    quotient = from_magnitude(q, a.is_negative() != b.is_negative());
+    remainder = from_magnitude(r, a.is_negative());
+}
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed>& BasicFixedInt<Bits, Signed>::operator/=(const BasicFixedInt& rhs) {
+    BasicFixedInt remainder;
+    divmod(*this, rhs, *this, remainder);
+    return *this;
+}
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed>& BasicFixedInt<Bits, Signed>::operator%=(const BasicFixedInt& rhs) {
+    BasicFixedInt quotient;
+    divmod(*this, rhs, quotient, *this);
+    return *this;
+}
+
+// shifts in place from the top limb down, so every limb is read before it is overwritten
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed>& BasicFixedInt<Bits, Signed>::operator<<=(size_t shift) {
+    size_t limb_shift = shift / 64;
+    unsigned int bit_shift = shift % 64;
+    for (size_t i = limb_count; i-- > 0; ) {
+        limb high = i >= limb_shift ? limbs[i - limb_shift] : 0;
+        limb low = i >= limb_shift + 1 ? limbs[i - limb_shift - 1] : 0;
+        limbs[i] = bit_shift == 0 ? high : (high << bit_shift) | (low >> (64 - bit_shift));
+    }
+    return *this;
+}
+
+// shifts in place from the bottom limb up, filling with the sign bit (zeros in a FixedUInt)
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed>& BasicFixedInt<Bits, Signed>::operator>>=(size_t shift) {
+    limb fill = is_negative() ? ~(limb)0 : 0;
+    size_t limb_shift = shift / 64;
+    unsigned int bit_shift = shift % 64;
+    for (size_t i = 0; i < limb_count; i++) {
+        limb low = limb_shift < limb_count - i ? limbs[i + limb_shift] : fill;
+        limb high = limb_shift + 1 < limb_count - i ? limbs[i + limb_shift + 1] : fill;
+        limbs[i] = bit_shift == 0 ? low : (low >> bit_shift) | (high << (64 - bit_shift));
+    }
+    return *this;
+}
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed>& BasicFixedInt<Bits, Signed>::operator++() {
+    bigint_detail::add_1(limbs.data(), limbs.data(), limb_count, 1);
+    return *this;
+}
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed> BasicFixedInt<Bits, Signed>::operator++(int) {
+    BasicFixedInt old = *this;
+    ++*this;
+    return old;
+}
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed>& BasicFixedInt<Bits, Signed>::operator--() {
+    return *this -= 1;
+}
+
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed> BasicFixedInt<Bits, Signed>::operator--(int) {
+    BasicFixedInt old = *this;
+    --*this;
+    return old;
+}
+
+template <size_t Bits, bool Signed>
+inline std::pair<BasicFixedInt<Bits, Signed>, BasicFixedInt<Bits, Signed>> divmod(const BasicFixedInt<Bits, Signed>& a, const BasicFixedInt<Bits, Signed>& b) {
+    BasicFixedInt<Bits, Signed> quotient, remainder;
+    BasicFixedInt<Bits, Signed>::divmod(a, b, quotient, remainder);
+    return {quotient, remainder};
+}
+
+template <size_t Bits, bool Signed>
+inline std::ostream& operator<<(std::ostream& out, const BasicFixedInt<Bits, Signed>& x) {
+    return out << x.to_string();
+}
+
+
+// ////////// FixedInt Number Theory ////////// //
+
+// modular exponentiation by fixed windows: in Montgomery form (R = 2^Bits) for odd moduli, reducing each
+// double-width product by division otherwise
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed> BasicFixedInt<Bits, Signed>::mod_pow(const BasicFixedInt& exponent, const BasicFixedInt& modulus) const {
+    using bigint_detail::dlimb;
+    if (exponent.is_negative()) {
+        throw std::domain_error("FixedInt: mod_pow with a negative exponent");
+    }
+    if (modulus.is_negative() || modulus.is_zero()) {
+        throw std::domain_error("FixedInt: mod_pow with a non-positive modulus");
+    }
+    if (modulus == 1) {
+        return 0;
+    }
+
+    // the base in [0, modulus)
+    BasicFixedInt base = *this % modulus;
+    if (base.is_negative()) {
+        base += modulus;
+    }
+    const Limbs& m = modulus.limbs;
+
+    if (m[0] % 2 == 1) {
+        limb inverse = m[0];  // Newton's iteration for 1 / m mod 2^64, each step doubles the correct low bits
+        for (int i = 0; i < 5; i++) {
+            inverse *= 2 - m[0] * inverse;
+        }
+        inverse = 0 - inverse;
+
+        // R mod m and R^2 mod m, by division
+        std::array<limb, 2 * limb_count> power{};
+        power[limb_count] = 1;
+        Limbs one = bigint_detail::fixed_reduce(power, m);
+        std::array<limb, 2 * limb_count> r_mod{};
+        for (size_t i = 0; i < limb_count; i++) {
+            r_mod[i + limb_count] = one[i];
+        }
+        Limbs r_squared = bigint_detail::fixed_reduce(r_mod, m);
+
+        // products are formed in full, then reduced
+        auto reduce = [&](std::array<limb, 2 * limb_count>& t) { return bigint_detail::fixed_montgomery_reduce(t, m, inverse); };
+        auto multiply = [&](const Limbs& x, const Limbs& y) {
+            std::array<limb, 2 * limb_count> product{};
+            bigint_detail::mul_basecase(product.data(), x.data(), limb_count, y.data(), limb_count);
+            return reduce(product);
+        };
+        auto square = [&](const Limbs& x) {
+            std::array<limb, 2 * limb_count> product{};
+            bigint_detail::sqr_basecase(product.data(), x.data(), limb_count);
+            return reduce(product);
+        };
+
+        Limbs x = multiply(base.limbs, r_squared);  // into Montgomery form
+        std::array<limb, 2 * limb_count> result{};
+        Limbs power_of_x = bigint_detail::fixed_window_pow(x, exponent.limbs, one, multiply, square);
+        for (size_t i = 0; i < limb_count; i++) {
+            result[i] = power_of_x[i];
+        }
+        BasicFixedInt value;
+        value.limbs = reduce(result);  // back out of Montgomery form
+        return value;
+    }
+
+    auto multiply = [&](const Limbs& x, const Limbs& y) {
+        std::array<limb, 2 * limb_count> product{};
+        bigint_detail::mul_basecase(product.data(), x.data(), limb_count, y.data(), limb_count);
+        return bigint_detail::fixed_reduce(product, m);
+    };
+    auto square = [&](const Limbs& x) {
+        std::array<limb, 2 * limb_count> product{};
+        bigint_detail::sqr_basecase(product.data(), x.data(), limb_count);
+        return bigint_detail::fixed_reduce(product, m);
+    };
+    BasicFixedInt value;
+    value.limbs = bigint_detail::fixed_window_pow(base.limbs, exponent.limbs, Limbs{{1}}, multiply, square);
+    return value;
+}
+
+// binary GCD on the magnitudes: strips the common factors of 2, then subtracts the smaller odd value from the larger
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed> BasicFixedInt<Bits, Signed>::gcd(const BasicFixedInt& other) const {
+    typedef BasicFixedInt<Bits, false> Magnitude;  // the magnitude of the most negative value needs the top bit
+    Magnitude a, b;
+    a.limbs = magnitude();
+    b.limbs = other.magnitude();
+    if (a.is_zero() || b.is_zero()) {
+        BasicFixedInt result;
+        result.limbs = a.is_zero() ? b.limbs : a.limbs;
+        return result;
+    }
+
+    auto trailing_zeros = [](const Magnitude& x) {
+        size_t i = 0;
+        while (x.limbs[i] == 0) {
+            i++;
+        }
+        return 64 * i + __builtin_ctzll(x.limbs[i]);
+    };
+    size_t za = trailing_zeros(a), zb = trailing_zeros(b);
+    size_t common = za < zb ? za : zb;
+    a >>= za;
+    b >>= zb;
+    while (true) {  // both odd
+        if (a > b) {
+            Magnitude t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+        if (b.is_zero()) {
+            break;
+        }
+        b >>= trailing_zeros(b);
+    }
+    a <<= common;
+
+    BasicFixedInt result;
+    result.limbs = a.limbs;
+    return result;
+}
+
+// the extended Euclidean algorithm on magnitudes: the Bezout coefficients of a alternate in sign and grow in
+// size, so only their magnitudes are tracked (t_{k+1} = t_{k-1} + q * t_k, never above the modulus)
+template <size_t Bits, bool Signed>
+constexpr BasicFixedInt<Bits, Signed> BasicFixedInt<Bits, Signed>::mod_inverse(const BasicFixedInt& modulus) const {
+    typedef BasicFixedInt<Bits, false> Magnitude;
+    if (modulus.is_negative() || modulus.is_zero()) {
+        throw std::domain_error("FixedInt: modular inverse with a non-positive modulus");
+    }
+    BasicFixedInt reduced = *this % modulus;
+    if (reduced.is_negative()) {
+        reduced += modulus;
+    }
+
+    Magnitude r0, r1, t0 = 0, t1 = 1, q, r;
+    r0.limbs = modulus.limbs;
+    r1.limbs = reduced.limbs;
+    bool odd_steps = false;
+    while (!r1.is_zero()) {
+        Magnitude::divmod(r0, r1, q, r);
+        r0 = r1;
+        r1 = r;
+        Magnitude t = t0 + q * t1;
+        t0 = t1;
+        t1 = t;
+        odd_steps = !odd_steps;
+    }
+    if (r0 != 1) {
+        throw std::domain_error("FixedInt has no modular inverse: not coprime to the modulus");
+    }
+
+    // t0 is the magnitude of the coefficient, which is negative after an even number of steps
+    Magnitude m;
+    m.limbs = modulus.limbs;
+    if (!odd_steps && !t0.is_zero()) {
+        t0 = m - t0;
+    }
+    BasicFixedInt result;
+    result.limbs = t0.limbs;
+    return result;
+}
+
+
+#endif
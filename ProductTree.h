@@ -0,0 +1,225 @@
+#ifndef __PRODUCTTREE_H__
+#define __PRODUCTTREE_H__
+
+#include <vector> // for the levels of the tree
+#include "BigInt.h" // for the arithmetic, and the thread pool the levels are spread over
+
+
+// ////////// Product Tree ////////// //
+
+// a balanced binary tree of products over a list of numbers: level 0 holds the numbers themselves, and each level
+// above holds the products of adjacent pairs (an odd one out moves up unchanged) up to a single root. Pairing
+// numbers of similar size makes every level cost about one multiplication of the root's size, where a running
+// product would cost one per number; walking back down with remainders reduces one number mod every leaf the
+// same way. Under ExecutionPolicy::parallel the nodes of each level are spread over the thread pool
+// (ex: ProductTree tree(moduli); std::vector<BigInt> r = tree.remainders(x);)
+class ProductTree {
+public:
+    explicit ProductTree(const std::vector<BigInt>&);  // ex: ProductTree tree(moduli) (builds every level)
+
+    size_t size() const;  // returns the number of leaves
+    size_t height() const;  // returns the number of levels, leaves and root included (0 for no leaves)
+    const std::vector<BigInt>& level(size_t) const;  // returns a level (0: the leaves, height() - 1: the root)
+    const BigInt& product() const;  // returns the product of every leaf (1 for no leaves)
+
+    std::vector<BigInt> remainders(const BigInt&) const;  // returns x % leaf for every leaf (ex: {17 % 3, 17 % 5} for x = 17)
+
+private:
+    std::vector<std::vector<BigInt>> levels;
+    BigInt one = 1;
+};
+
+// the product of a stream of numbers without keeping the stream: like a binary counter it holds one partial
+// product per power of two (merging two of the same count as soon as they appear), so the multiplications are
+// balanced like a product tree's while only O(log k) partial products are kept
+// (ex: StreamingProduct p; while (file >> m) { p.push(m); } BigInt all = p.product();)
+class StreamingProduct {
+public:
+    void push(const BigInt&);  // multiplies a number in
+    size_t size() const;  // returns how many numbers were pushed
+    BigInt product() const;  // returns the product of every number pushed so far (1 for none)
+
+private:
+    std::vector<std::pair<BigInt, size_t>> partial;  // partial products and how many numbers each covers, largest first
+    size_t count = 0;
+};
+
+inline BigInt product(const std::vector<BigInt>& values);  // ex: product({2, 3, 5}) == 30 (one level at a time, without keeping the tree)
+inline std::vector<BigInt> batch_gcd(const std::vector<BigInt>& moduli, size_t chunk = 0);  // ex: batch_gcd({15, 21, 11}) == {3, 3, 1}
+
+
+namespace bigint_detail {
+
+// runs body(i) for every node i of a level, spread over the thread pool under ExecutionPolicy::parallel
+template <typename Body>
+inline void for_each_node(size_t count, const Body& body) {
+    if (!parallel_enabled()) {
+        for (size_t i = 0; i < count; i++) {
+            body(i);
+        }
+        return;
+    }
+    parallel_for(count, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            body(i);
+        }
+    });
+}
+
+// the level above: products of adjacent pairs, with an odd one out moved up as is
+inline std::vector<BigInt> pair_products(const std::vector<BigInt>& below) {
+    std::vector<BigInt> above((below.size() + 1) / 2);
+    for_each_node(above.size(), [&](size_t i) {
+        above[i] = 2 * i + 1 < below.size() ? below[2 * i] * below[2 * i + 1] : below[2 * i];
+    });
+    return above;
+}
+
+}  // namespace bigint_detail
+
+inline ProductTree::ProductTree(const std::vector<BigInt>& leaves) {
+    if (leaves.empty()) {
+        return;
+    }
+    levels.push_back(leaves);
+    while (levels.back().size() > 1) {
+        levels.push_back(bigint_detail::pair_products(levels.back()));
+    }
+}
+
+inline size_t ProductTree::size() const {
+    return levels.empty() ? 0 : levels[0].size();
+}
+
+inline size_t ProductTree::height() const {
+    return levels.size();
+}
+
+inline const std::vector<BigInt>& ProductTree::level(size_t i) const {
+    return levels.at(i);
+}
+
+inline const BigInt& ProductTree::product() const {
+    return levels.empty() ? one : levels.back()[0];
+}
+
+// each node's remainder is its parent's remainder mod the node: the parent is a multiple of the node, so this
+// equals x % node, from a dividend only about twice the node's size (the signs work out like x % leaf too)
+inline std::vector<BigInt> ProductTree::remainders(const BigInt& x) const {
+    if (levels.empty()) {
+        return {};
+    }
+    std::vector<BigInt> current = {x % levels.back()[0]};
+    for (size_t k = levels.size() - 1; k-- > 0; ) {
+        const std::vector<BigInt>& nodes = levels[k];
+        std::vector<BigInt> below(nodes.size());
+        bigint_detail::for_each_node(nodes.size(), [&](size_t i) {
+            below[i] = current[i / 2] % nodes[i];
+        });
+        current.swap(below);
+    }
+    return current;
+}
+
+inline void StreamingProduct::push(const BigInt& value) {
+    partial.emplace_back(value, 1);
+    count++;
+    while (partial.size() >= 2 && partial[partial.size() - 2].second == partial.back().second) {
+        std::pair<BigInt, size_t> last = std::move(partial.back());
+        partial.pop_back();
+        partial.back().first *= last.first;
+        partial.back().second += last.second;
+    }
+}
+
+inline size_t StreamingProduct::size() const {
+    return count;
+}
+
+inline BigInt StreamingProduct::product() const {
+    if (partial.empty()) {
+        return 1;
+    }
+    BigInt result = partial.back().first;
+    for (size_t i = partial.size() - 1; i-- > 0; ) {
+        result = partial[i].first * result;
+    }
+    return result;
+}
+
+inline BigInt product(const std::vector<BigInt>& values) {
+    if (values.empty()) {
+        return 1;
+    }
+    std::vector<BigInt> level = values;
+    while (level.size() > 1) {
+        level = bigint_detail::pair_products(level);
+    }
+    return level[0];
+}
+
+
+// ////////// Batch GCD ////////// //
+
+namespace bigint_detail {
+
+// Bernstein's descent: with P the product of all the moduli (a multiple of every node), P mod node^2 is taken
+// from the parent's remainder all the way down, and at a leaf m, (P mod m^2) / m = (P / m) mod m, whose gcd
+// with m is the gcd of m with the product of all the others
+inline std::vector<BigInt> batch_gcd_descent(const ProductTree& tree, const BigInt& total) {
+    const std::vector<BigInt>& top = tree.level(tree.height() - 1);
+    BigInt top_square = top[0] * top[0];
+    std::vector<BigInt> current = {total < top_square ? total : total % top_square};
+    for (size_t k = tree.height() - 1; k-- > 0; ) {
+        const std::vector<BigInt>& nodes = tree.level(k);
+        std::vector<BigInt> below(nodes.size());
+        for_each_node(nodes.size(), [&](size_t i) {
+            below[i] = current[i / 2] % (nodes[i] * nodes[i]);
+        });
+        current.swap(below);
+    }
+
+    const std::vector<BigInt>& leaves = tree.level(0);
+    for_each_node(leaves.size(), [&](size_t i) {
+        BigInt cofactor = current[i] / leaves[i];
+        current[i] = cofactor.gcd(leaves[i]);
+    });
+    return current;
+}
+
+}  // namespace bigint_detail
+
+// gcd(m, product of all the other moduli) for every modulus, in quasi-linear time instead of comparing every pair:
+// 1 for a modulus sharing no factor with the rest (ex: an RSA modulus with a repeated prime shows up as that prime).
+// A chunk size above 0 streams the work: only the full product and one chunk's tree are held at a time,
+// at the cost of reducing the full product once per chunk. Throws std::domain_error for a modulus below 1
+inline std::vector<BigInt> batch_gcd(const std::vector<BigInt>& moduli, size_t chunk) {
+    for (const BigInt& modulus : moduli) {
+        if (modulus < 1) {
+            throw std::domain_error("BigInt: batch_gcd needs positive moduli");
+        }
+    }
+    if (moduli.empty()) {
+        return {};
+    }
+    if (chunk == 0 || chunk >= moduli.size()) {
+        ProductTree tree(moduli);
+        return bigint_detail::batch_gcd_descent(tree, tree.product());
+    }
+
+    BigInt total = product(moduli);
+    std::vector<BigInt> result;
+    result.reserve(moduli.size());
+    for (size_t begin = 0; begin < moduli.size(); begin += chunk) {
+        size_t end = std::min(begin + chunk, moduli.size());
+        ProductTree tree(std::vector<BigInt>(moduli.begin() + begin, moduli.begin() + end));
+        std::vector<BigInt> part = bigint_detail::batch_gcd_descent(tree, total);
+        for (BigInt& g : part) {
+            result.push_back(std::move(g));
+        }
+    }
+    return result;
+}
+
+
+#endif
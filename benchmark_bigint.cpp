@@ -0,0 +1,352 @@
+#include "BigInt.h"
+#include <chrono> // for timing
+#include <fstream> // for the output and baseline files
+#include <sstream> // for splitting baseline lines
+#include <random> // for the operands
+#include <map> // for the baseline, by operation and size
+#include <functional> // for std::function, the prepared operations
+#include <atomic> // for the allocation counter, which pool workers bump too
+#include <cstdlib> // for std::malloc and std::free, behind the counting operator new
+
+// times every operation on random operands from 64 bits to 10 million decimal digits, printing ops/sec and
+// heap allocations per operation as CSV or JSON, and optionally compares against a stored baseline
+//
+// ex: benchmark_bigint --format csv --output baseline.csv        (record a baseline)
+//     benchmark_bigint --compare baseline.csv --tolerance 0.1    (exit 1 on anything 10% slower, or allocating more)
+//     benchmark_bigint --ops mul,div --max-bits 65536 --min-time 1
+
+using namespace std;
+
+
+// ////////// Allocation Counting ////////// //
+
+// every heap allocation goes through here (BigInt's limb pool and scratch arena included), so a pool hit costs
+// nothing and a miss counts as one allocation
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t bytes) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(bytes ? bytes : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// (not inlined, or GCC pairs the free with the inlined operator new and warns of a mismatch)
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+
+// ////////// Operations ////////// //
+
+// the operand sizes (in bits); the last is 10 million decimal digits
+static const vector<size_t> sizes = {64, 256, 2048, 16384, 131072, 1048576, 33219281};
+
+struct Operation {
+    string name;
+    size_t max_bits;  // the largest size it is timed at (mod_pow and friends are quadratic or worse, and would take hours)
+};
+
+static const vector<Operation> operations = {
+    {"add", 33219281}, {"sub", 33219281}, {"mul", 33219281}, {"div", 33219281}, {"mod", 33219281},
+    {"pow", 33219281}, {"mod_pow", 16384}, {"sqrt", 33219281}, {"gcd", 131072}, {"mod_inverse", 131072},
+    {"is_prime", 2048}, {"parse", 33219281}, {"print", 33219281}
+};
+
+static mt19937_64 generator(12345);
+
+// a random number of exactly 'bits' bits
+static BigInt random_bits(size_t bits) {
+    vector<uint8_t> bytes((bits + 7) / 8);
+    for (uint8_t& byte : bytes) {
+        byte = (uint8_t)generator();
+    }
+    if (bits % 8 != 0) {
+        bytes[0] &= (uint8_t)((1 << (bits % 8)) - 1);
+    }
+    bytes[0] |= (uint8_t)(1 << ((bits + 7) % 8));
+    return BigInt::from_bytes(bytes);
+}
+
+static volatile size_t sink;  // keeps results alive
+
+// returns a function doing one operation on operands of the given size (set up outside the timing)
+static function<void()> prepare(const string& name, size_t bits) {
+    BigInt a = random_bits(bits), b = random_bits(bits);
+    if (name == "add") {
+        return [a, b]() { sink = (a + b).size(); };
+    }
+    if (name == "sub") {
+        return [a, b]() { sink = (a - b).size(); };
+    }
+    if (name == "mul") {
+        return [a, b]() { sink = (a * b).size(); };
+    }
+    if (name == "div" || name == "mod") {
+        BigInt dividend = random_bits(2 * bits);
+        if (name == "div") {
+            return [dividend, b]() { sink = (dividend / b).size(); };
+        }
+        return [dividend, b]() { sink = (dividend % b).size(); };
+    }
+    if (name == "pow") {
+        BigInt base = random_bits(64);
+        BigInt exponent = max<size_t>(bits / 64, 1);  // a result of about 'bits' bits
+        return [base, exponent]() { BigInt x = base; sink = x.pow(exponent).size(); };
+    }
+    if (name == "mod_pow") {
+        BigInt modulus = random_bits(bits);
+        if (modulus % 2 == 0) {
+            modulus += 1;
+        }
+        BigInt base = a % modulus;
+        return [base, b, modulus]() { BigInt x = base; sink = x.mod_pow(b, modulus).size(); };
+    }
+    if (name == "sqrt") {
+        return [a]() { sink = a.sqrt().size(); };
+    }
+    if (name == "gcd") {
+        return [a, b]() { BigInt x = a; sink = x.gcd(b).size(); };
+    }
+    if (name == "mod_inverse") {
+        BigInt x = a, modulus = b;
+        while (BigInt(x).gcd(modulus) != 1) {
+            x += 1;
+        }
+        return [x, modulus]() { BigInt y = x; sink = y.mod_inverse(modulus).size(); };
+    }
+    if (name == "is_prime") {
+        BigInt p = next_prime(a);  // the slow case: a prime goes through every round
+        return [p]() { BigInt x = p; sink = x.is_prime(); };
+    }
+    if (name == "parse") {
+        string text = a.to_string();
+        return [text]() { sink = BigInt(text).size(); };
+    }
+    if (name == "print") {
+        return [a]() { sink = a.to_string().size(); };
+    }
+    throw invalid_argument("unknown operation " + name);
+}
+
+
+// ////////// Measurement ////////// //
+
+struct Result {
+    string name;
+    size_t bits;
+    size_t iterations;
+    double seconds;
+    double ops_per_second;
+    double allocations_per_op;
+};
+
+// runs the operation until at least min_time seconds have passed (at least once, after one untimed warm-up
+// that fills the limb pool and the cached powers), doubling the batch so the clock is read rarely
+static Result measure(const string& name, size_t bits, double min_time) {
+    function<void()> operation = prepare(name, bits);
+    operation();
+
+    size_t iterations = 0, batch = 1, allocated = 0;
+    double seconds = 0;
+    do {
+        size_t before = allocations.load(std::memory_order_relaxed);
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < batch; i++) {
+            operation();
+        }
+        seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        allocated += allocations.load(std::memory_order_relaxed) - before;
+        iterations += batch;
+        batch *= 2;
+    } while (seconds < min_time);
+    return {name, bits, iterations, seconds, iterations / seconds, (double)allocated / iterations};
+}
+
+
+// ////////// Output and Comparison ////////// //
+
+static void write_csv(ostream& os, const vector<Result>& results) {
+    os << "operation,bits,iterations,seconds,ops_per_sec,allocations_per_op\n";
+    for (const Result& r : results) {
+        os << r.name << "," << r.bits << "," << r.iterations << "," << r.seconds << "," << r.ops_per_second << "," << r.allocations_per_op << "\n";
+    }
+}
+
+// one object per line, so the baseline reader can take either format
+static void write_json(ostream& os, const vector<Result>& results) {
+    os << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        os << "  {\"operation\": \"" << r.name << "\", \"bits\": " << r.bits << ", \"iterations\": " << r.iterations
+           << ", \"seconds\": " << r.seconds << ", \"ops_per_sec\": " << r.ops_per_second
+           << ", \"allocations_per_op\": " << r.allocations_per_op << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "]\n";
+}
+
+// the value after "key": on a JSON line
+static string json_field(const string& line, const string& key) {
+    size_t at = line.find("\"" + key + "\":");
+    if (at == string::npos) {
+        return "";
+    }
+    at += key.size() + 3;
+    while (at < line.size() && (line[at] == ' ' || line[at] == '"')) {
+        at++;
+    }
+    size_t end = line.find_first_of(",\"}", at);
+    return line.substr(at, end - at);
+}
+
+// reads a baseline written by either format, keyed by (operation, bits)
+static map<pair<string, size_t>, Result> read_baseline(const string& path) {
+    ifstream file(path);
+    if (!file) {
+        throw runtime_error("can't open baseline " + path);
+    }
+    map<pair<string, size_t>, Result> baseline;
+    string line;
+    while (getline(file, line)) {
+        Result r;
+        if (line.find('{') != string::npos) {
+            r.name = json_field(line, "operation");
+            r.bits = stoull(json_field(line, "bits"));
+            r.ops_per_second = stod(json_field(line, "ops_per_sec"));
+            r.allocations_per_op = stod(json_field(line, "allocations_per_op"));
+        }
+        else if (!line.empty() && line.compare(0, 10, "operation,") != 0 && line[0] != '[' && line[0] != ']') {
+            stringstream fields(line);
+            string field;
+            vector<string> values;
+            while (getline(fields, field, ',')) {
+                values.push_back(field);
+            }
+            if (values.size() < 6) {
+                throw runtime_error("malformed baseline line: " + line);
+            }
+            r.name = values[0];
+            r.bits = stoull(values[1]);
+            r.ops_per_second = stod(values[4]);
+            r.allocations_per_op = stod(values[5]);
+        }
+        else {
+            continue;
+        }
+        baseline[{r.name, r.bits}] = r;
+    }
+    return baseline;
+}
+
+// flags every result more than 'tolerance' slower than the baseline, or allocating more per operation
+// (allocation counts are deterministic, so any increase of a whole allocation is a real change); returns how many
+static size_t compare(const vector<Result>& results, const map<pair<string, size_t>, Result>& baseline, double tolerance) {
+    size_t regressions = 0;
+    for (const Result& r : results) {
+        auto found = baseline.find({r.name, r.bits});
+        if (found == baseline.end()) {
+            continue;
+        }
+        const Result& old = found->second;
+        double ratio = r.ops_per_second / old.ops_per_second;
+        bool slower = ratio < 1 - tolerance;
+        bool allocating = r.allocations_per_op >= old.allocations_per_op + 1;
+        cerr << (slower || allocating ? "REGRESSION " : "ok         ") << r.name << " " << r.bits << " bits: " << ratio << "x speed, "
+             << old.allocations_per_op << " -> " << r.allocations_per_op << " allocations" << endl;
+        regressions += slower || allocating;
+    }
+    return regressions;
+}
+
+
+// ////////// Main ////////// //
+
+static void usage() {
+    cerr << "usage: benchmark_bigint [--format csv|json] [--output file] [--ops add,mul,...] [--max-bits n]\n"
+            "                        [--min-time seconds] [--compare baseline] [--tolerance fraction]" << endl;
+}
+
+int main(int argc, char** argv) {
+    string format = "csv", output, baseline_path, only;
+    size_t max_bits = sizes.back();
+    double min_time = 0.2, tolerance = 0.1;
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        string value = argv[++i];
+        if (option == "--format" && (value == "csv" || value == "json")) {
+            format = value;
+        }
+        else if (option == "--output") {
+            output = value;
+        }
+        else if (option == "--ops") {
+            only = "," + value + ",";
+        }
+        else if (option == "--max-bits") {
+            max_bits = stoull(value);
+        }
+        else if (option == "--min-time") {
+            min_time = stod(value);
+        }
+        else if (option == "--compare") {
+            baseline_path = value;
+        }
+        else if (option == "--tolerance") {
+            tolerance = stod(value);
+        }
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    map<pair<string, size_t>, Result> baseline;
+    if (!baseline_path.empty()) {
+        baseline = read_baseline(baseline_path);
+    }
+
+    vector<Result> results;
+    for (const Operation& operation : operations) {
+        if (!only.empty() && only.find("," + operation.name + ",") == string::npos) {
+            continue;
+        }
+        for (size_t bits : sizes) {
+            if (bits > max_bits || bits > operation.max_bits) {
+                continue;
+            }
+            results.push_back(measure(operation.name, bits, min_time));
+            cerr << operation.name << " " << bits << " bits: " << results.back().ops_per_second << " ops/sec" << endl;
+        }
+    }
+
+    ofstream file;
+    if (!output.empty()) {
+        file.open(output);
+        if (!file) {
+            cerr << "can't write " << output << endl;
+            return 2;
+        }
+    }
+    ostream& os = output.empty() ? cout : file;
+    if (format == "json") {
+        write_json(os, results);
+    }
+    else {
+        write_csv(os, results);
+    }
+
+    if (!baseline_path.empty() && compare(results, baseline, tolerance) > 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -1,5 +1,10 @@
 //#include "BigInt.h"
 #include "BigInt.h"
+#include "FixedInt.h"
+#include "BigIntBatch.h"
+#include "ProductTree.h"
+#include "BigIntIO.h"
+#include <sstream>
 
 using namespace std;
 
@@ -19,6 +24,183 @@ int main() {
     BigInt d(8); c = d;  cout << c << " ";
     cout << endl;
 
+    cout << "Small values:    ";  // should be:  -2147483648 0 1 1 1
+    a = -2147483647 - 1; cout << a << " ";
+    a = -0;              cout << a << " ";
+    cout << (BigInt(123).number.is_inline()) << " ";  // no heap block for small values
+    a = "340282366920938463463374607431768211456";  // 2^128
+    c = a * a * a;       cout << (!c.number.is_inline() && c / a / a == a) << " ";  // 2^384 moves to the heap
+    c.swap(b);           cout << (b.size() == 7 && c == BigInt(2)) << " ";
+    cout << endl;
+
+    cout << "Moves/aliasing:  ";  // should be:  -2 3 14 0 36 0 1
+    cout << BigInt(5) - BigInt(7) << " ";  // both operands expiring
+    a = 10;              cout << a - (BigInt(2) + 5) << " ";  // right operand expiring
+    a = 7;  a += a;      cout << a << " ";
+    a -= a;              cout << a << " ";
+    a = -6; a *= a;      cout << a << " ";
+    c = std::move(a);    cout << a << " ";  // a moved-from BigInt is zero
+    cout << (c == 36) << " ";
+    cout << endl;
+
+    cout << "Shifts/lazy():   ";  // should be:  40 -3 26 -14 2 1
+    cout << (BigInt(5) << 3) << " " << (BigInt(-5) >> 1) << " ";
+    a = 4; b = 5; c = 6;
+    d = lazy(a) * b + c;        cout << d << " ";  // one fused multiply-add
+    d = c - lazy(a) * b;        cout << d << " ";
+    d = lazy(a) * b % c;        cout << d << " ";
+    d = (lazy(a) + b) >> 3;     cout << d << " ";
+    cout << endl;
+
+    cout << "Memory:   ";  // should be:  1 1 0 1
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        BigInt e(&arena);
+        e = BigInt(2).pow(1000);
+        BigInt::set_memory_resource(&arena);
+        BigInt f = e * e;
+        BigInt::set_memory_resource(nullptr);
+        BigInt g = f;
+        cout << (e.memory_resource() == &arena) << " " << (f.memory_resource() == &arena) << " ";
+        cout << (g.memory_resource() == &arena) << " " << (g == BigInt(2).pow(2000)) << endl;
+    }
+
+    cout << "FixedInt:   ";  // should be:  -11 1 0 6 5 1 1 1267650600228229401496703205376 -1267650600228229401496703205376
+    {
+        constexpr FixedInt<128> x = FixedInt<128>(-7) * 5 / 3;  // evaluated at compile time
+        static_assert(x == -11, "constexpr FixedInt arithmetic");
+        FixedUInt<256> m(BigInt(2).pow(255) - 19);
+        FixedUInt<256> zero = 0;
+        cout << x << " " << FixedUInt<256>(2).mod_pow(m - 1, m) << " " << (zero - 1) + 1 << " ";
+        cout << FixedUInt<256>(12).gcd(18) << " " << FixedUInt<256>(3).mod_inverse(7) << " ";
+        cout << (FixedUInt<256>(m).to_bigint() == BigInt(2).pow(255) - 19) << " " << ((FixedInt<64>(-5) >> 1) == -3) << " ";
+        cout << FixedUInt<256>((unsigned __int128)1 << 100) << " " << FixedInt<256>(-((__int128)1 << 100)) << endl;
+    }
+
+    cout << "Literals:   ";  // should be:  340282366920938463463374607431768211457 -255 11 493 1000000 1 1
+    {
+        static constexpr auto p = 340282366920938463463374607431768211457_big;  // parsed at compile time
+        static_assert(p.limbs.size() == 3, "2^128 + 1 takes three limbs");
+        constexpr FixedUInt<128> q = 0xffff'ffff'ffff'ffff'ffff'ffff'ffff'ffff_big;
+        a = p;
+        cout << a << " " << BigInt(-0xff_big) << " " << BigInt(0b1011_big) << " " << BigInt(0755_big) << " ";
+        cout << BigInt(1'000'000_big) << " " << (a == BigInt(2).pow(128) + 1) << " " << (q + 1 == 0) << endl;
+    }
+
+    cout << "Native integers:   ";  // should be:  18446744073709551616 -8 6 -2 1 1 1 1 -170141183460469231731687303715884105728 1
+    {
+        BigInt e = 18446744073709551615ULL;
+        e += 1;                           cout << e << " ";
+        e = -9;                           cout << e + 1 << " " << 3 - e / 3 << " " << e % 7 << " ";
+        cout << (e % 2 == -1) << " " << (e < 0) << " " << (5 > e) << " ";
+        __int128 minimum = (__int128)1 << 127;
+        cout << (BigInt(minimum).to_int128() == minimum) << " " << BigInt(minimum) << " ";
+        bool threw = false;
+        try { BigInt("4294967296").to_uint(); } catch (std::out_of_range&) { threw = true; }
+        cout << threw << endl;
+    }
+
+    cout << "Batch:   ";  // should be:  1 1 18446744073709551615 20
+    {
+        vector<BigInt> x, y;
+        for (int i = 0; i < 20; i++) {
+            x.push_back(BigInt(2).pow(100) + i);
+            y.push_back(BigInt(3).pow(50) * i);
+        }
+        BigInt m = BigInt(2).pow(127) - 1;
+        vector<BigInt> products = batch_mul(x, y), residues = batch_mulmod(x, y, m);
+        bool same = true, same_mod = true;
+        for (int i = 0; i < 20; i++) {
+            same = same && products[i] == x[i] * y[i];
+            same_mod = same_mod && residues[i] == x[i] * y[i] % m;
+        }
+        BigIntBatch zero(1, 1), one({BigInt(1)}, 1), wrapped(1, 1);
+        batch_sub(zero, one, wrapped);
+        cout << same << " " << same_mod << " " << wrapped.get(0) << " " << BigIntBatch(x).to_vector().size() << endl;
+    }
+
+    cout << "Parallel:   ";  // should be:  1 1 4
+    {
+        unsigned int threshold = BigInt::parallel_threshold;
+        BigInt::set_thread_count(4);
+        BigInt::parallel_threshold = 16;  // small, so every engine forks
+        BigInt x = BigInt(3).pow(100000), y = BigInt(7).pow(60000);
+        cout << (multiply(ExecutionPolicy::parallel, x, y) == x * y) << " ";
+        cout << (divmod(ExecutionPolicy::parallel, x * x + 1, y) == divmod(x * x + 1, y)) << " " << BigInt::thread_count() << endl;
+        BigInt::set_thread_count(0);
+        BigInt::parallel_threshold = threshold;
+    }
+
+    cout << "Primes:   ";  // should be:  101 18446744073709551629 1 1
+    {
+        std::mt19937_64 generator(2024);
+        BigInt p = random_prime(128, generator), q = random_safe_prime(64, generator);
+        cout << next_prime(100) << " " << next_prime(BigInt(2).pow(64)) << " " << (p.bit_length() == 128 && p.is_prime()) << " ";
+        cout << (q.bit_length() == 64 && q.is_prime() && ((q - 1) / 2).is_prime()) << endl;
+    }
+
+    cout << "Product tree:   ";  // should be:  3465 2 17 6 3 3 1 1
+    {
+        vector<BigInt> moduli = {BigInt(15), BigInt(21), BigInt(11)};
+        ProductTree tree(moduli);
+        vector<BigInt> r = tree.remainders(17), g = batch_gcd(moduli), h = batch_gcd(moduli, 2);
+        cout << tree.product() << " " << r[0] << " " << r[1] << " " << r[2] << " ";
+        cout << g[0] << " " << g[1] << " " << g[2] << " " << (h == g) << endl;
+    }
+
+    cout << "Bytes:   ";  // should be:  2 1 2 0 0 1 3 30 1 1
+    {
+        BigInt e = 258;
+        vector<uint8_t> big = e.to_bytes(), padded = e.to_bytes(4, ByteOrder::little_endian);
+        cout << big.size() << " " << (int)big[0] << " " << (int)big[1] << " " << (int)padded[2] << " " << (int)padded[3] << " ";
+        cout << (BigInt::from_bytes(padded, ByteOrder::little_endian) == 258) << " ";
+        vector<BigInt> values = {BigInt(-1), BigInt(0), BigInt(2).pow(200)};
+        vector<uint8_t> framed = to_framed(values);
+        cout << (int)framed[0] << " " << framed.size() << " " << (from_framed(framed) == values) << " ";
+        bool threw = false;
+        try { from_framed(framed.data(), framed.size() - 1); } catch (std::invalid_argument&) { threw = true; }
+        cout << threw << endl;
+    }
+
+    cout << "Streams: ";  // should be:  3 -345 1 1 1 1
+    {
+        BigInt huge = BigInt(10).pow(200000) + 1;
+        stringstream text;
+        {
+            BigIntWriter out(text, BigIntFormat::decimal, 64);  // the huge number goes past the buffer, a piece at a time
+            out.write({BigInt(12), BigInt(-345), huge});
+        }
+        BigIntReader in(text, BigIntFormat::decimal, 1000);
+        vector<BigInt> read;
+        BigInt x;
+        while (in.next(x)) {
+            read.push_back(x);
+        }
+        cout << read.size() << " " << read[1] << " " << (read[2] == huge) << " ";
+
+        stringstream one("-12 3x");
+        BigIntReader bad(one);
+        bool threw = false;
+        try { while (bad.next(x)) {} } catch (std::invalid_argument&) { threw = true; }
+        cout << threw << " ";
+
+        std::string path = "test_bigint_streams.tmp";
+        {
+            std::ofstream file(path, std::ios::binary);
+            BigIntWriter out(file, BigIntFormat::framed);
+            out.write(read);
+        }
+        {
+            MappedBigIntReader mapped(path, BigIntFormat::framed);
+            vector<BigInt> back;
+            while (mapped.next(x)) {
+                back.push_back(x);
+            }
+            cout << (back == read) << " " << (mapped.size() == to_framed(read).size()) << endl;
+        }
+        std::remove(path.c_str());
+    }
+
     cout << "Addition:        ";  // should be:  1 2 3 4 5 6 7 8 9
     a = 1;               cout << a << " ";
     a += 1;              cout << a << " ";
@@ -72,6 +254,50 @@ int main() {
     a = 19; a = a % BigInt(13);  cout << a << " ";
     cout << endl;
 
+    cout << "Divmod:          ";  // should be:  3 1 -3 -1 3 -1
+    std::pair<BigInt, BigInt> qr = divmod(BigInt(10), BigInt(3));  cout << qr.first << " " << qr.second << " ";
+    qr = divmod(BigInt(-10), BigInt(3));                          cout << qr.first << " " << qr.second << " ";
+    BigInt q, r;  divmod(BigInt(-10), BigInt(-3), q, r);           cout << q << " " << r << " ";
+    cout << endl;
+
+    cout << "Large multiply:  ";  // should be:  1 1 1 1 1 (Karatsuba, Toom-3 and the NTT agree with the elementary algorithm)
+    a = BigInt(3).pow(20000);                         // ~500 limbs, past both thresholds
+    b = BigInt(7).pow(15000) + 12345;
+    BigInt fast = a * b, fast_square = a;  fast_square *= fast_square;
+    unsigned int karatsuba_threshold = BigInt::karatsuba_threshold, toom3_threshold = BigInt::toom3_threshold;
+    BigInt::karatsuba_threshold = BigInt::toom3_threshold = 100000;  // forces the elementary algorithm
+    BigInt slow = a * b, slow_square = a;  slow_square *= slow_square;
+    BigInt::karatsuba_threshold = karatsuba_threshold;  BigInt::toom3_threshold = toom3_threshold;
+    cout << (fast == slow) << " " << (fast_square == slow_square) << " " << (fast_square == a * BigInt(a)) << " ";
+    unsigned int ntt_threshold = BigInt::ntt_threshold;
+    BigInt::ntt_threshold = 64;  // forces the number-theoretic transform
+    BigInt transformed = a * b, transformed_square = a;  transformed_square *= transformed_square;
+    BigInt::ntt_threshold = ntt_threshold;
+    cout << (transformed == slow) << " " << (transformed_square == slow_square) << " ";
+    cout << endl;
+
+    cout << "Large divide:    ";  // should be:  1 1 1 1 (Burnikel-Ziegler agrees with Knuth's long division)
+    BigInt dividend = a * b + (b - 1);
+    cout << (dividend / b == a) << " " << (dividend % b == b - 1) << " ";
+    unsigned int burnikel_ziegler_threshold = BigInt::burnikel_ziegler_threshold;
+    BigInt::burnikel_ziegler_threshold = 100000;  // forces Knuth's long division
+    cout << (dividend / b == a) << " " << (dividend % b == b - 1) << " ";
+    BigInt::burnikel_ziegler_threshold = burnikel_ziegler_threshold;
+    cout << endl;
+
+    cout << "Large decimal:   ";  // should be:  1 1 1 (divide-and-conquer conversion agrees with the chunked one)
+    std::string digits = "-9";
+    for (int i = 0; i < 3000; i++) {
+        digits += (char)('0' + (i * 7 + i / 13) % 10);
+    }
+    BigInt parsed(digits);
+    unsigned int decimal_conversion_threshold = BigInt::decimal_conversion_threshold;
+    BigInt::decimal_conversion_threshold = 1;  // forces the recursive split at every level
+    cout << (parsed.to_string() == digits) << " " << (BigInt(digits) == parsed) << " ";
+    BigInt::decimal_conversion_threshold = decimal_conversion_threshold;
+    cout << (parsed.to_string() == digits) << " ";
+    cout << endl;
+
     cout << endl;
 
     cout << "is_prime():      ";  // should be:  1 1 1 1 1 0
@@ -83,6 +309,16 @@ int main() {
     a = "324543"; cout << a.is_prime() << " ";
     cout << endl;    
 
+    cout << "is_prime(modes): ";  // should be:  1 1 1 0 0 0
+    a = "170141183460469231731687303715884105727";  // 2^127 - 1
+    cout << a.is_prime(PrimalityTest::deterministic) << " ";
+    cout << a.is_prime(PrimalityTest::baillie_psw) << " ";
+    cout << a.is_prime(PrimalityTest::miller_rabin, 10) << " ";
+    a = "3215031751";           cout << a.is_prime(PrimalityTest::deterministic) << " ";  // strong pseudoprime to bases 2, 3, 5, 7
+    a = "3825123056546413051";  cout << a.is_prime(PrimalityTest::baillie_psw) << " ";    // strong pseudoprime to bases 2 through 23
+    a = "3825123056546413051";  cout << a.is_prime(PrimalityTest::miller_rabin) << " ";
+    cout << endl;
+
     cout << "pow():           ";  // should be:  1 2 4 8 16 32 64
     a = 2;
     cout << a.pow(0) << " ";
@@ -107,6 +343,22 @@ int main() {
     cout << a.mod_pow("4", BigInt(13)) << " ";
     cout << endl;  
 
+    cout << "mod_pow(modes):  ";  // should be:  9 9 1 1 0 (constant-time, even modulus, zero exponent, modulus 1)
+    cout << a.mod_pow(4, 13, true) << " ";
+    cout << a.mod_pow(4, 12) << " ";
+    cout << a.mod_pow(0, 13) << " ";
+    cout << a.mod_pow(0, 13, true) << " ";
+    cout << a.mod_pow(4, 1, true) << " ";
+    cout << endl;
+
+    cout << "Montgomery:      ";  // should be:  9 9 9 1
+    MontgomeryContext context(13);
+    cout << context.pow(123, 4) << " ";
+    cout << context.from_montgomery(context.multiply(context.to_montgomery(3), context.to_montgomery(3))) << " ";
+    cout << context.from_montgomery(context.square(context.to_montgomery(16))) << " ";
+    cout << (MontgomeryContext(BigInt(2).pow(521) - 1).pow(3, BigInt(2).pow(521) - 2) == 1) << " ";  // Fermat, on a 9-limb prime
+    cout << endl;
+
     cout << "sqrt():          ";  // should be:  1 2 3 4 5 6 7 8 9
     cout << BigInt(1).sqrt() << " ";
     cout << BigInt(4).sqrt() << " ";
@@ -119,6 +371,14 @@ int main() {
     cout << BigInt(81).sqrt() << " ";
     cout << endl;    
 
+    cout << "sqrtrem/iroot(): ";  // should be:  3 1 10 -10 1
+    cout << BigInt(10).sqrtrem().first << " " << BigInt(10).sqrtrem().second << " ";
+    cout << BigInt(1000).iroot(3) << " ";
+    cout << BigInt(-1000).iroot(3) << " ";
+    a = "1267650600228229401496703205376";  // 2^100
+    cout << (a.iroot(10) == BigInt(1024) && (a - 1).iroot(10) == BigInt(1023) && a.sqrt() == BigInt("1125899906842624")) << " ";
+    cout << endl;
+
     cout << "modular_inverse():";  // should be:  1 2 3 4 5 6 7 8 9
     cout << BigInt(1).sqrt() << " ";
     cout << BigInt(4).sqrt() << " ";
@@ -131,6 +391,19 @@ int main() {
     cout << BigInt(81).sqrt() << " ";
     cout << endl;    
 
+    cout << "gcd/xgcd():      ";  // should be:  2 2 -9 47 4 1
+    cout << BigInt(240).gcd(46) << " ";
+    {
+        BigInt g, x, y;
+        std::tie(g, x, y) = xgcd(240, 46);
+        cout << g << " " << x << " " << y << " ";
+    }
+    cout << BigInt(3).mod_inverse(11) << " ";
+    a = "340282366920938463463374607431768211455";  // 2^128 - 1
+    b = "18446744073709551617";                     // 2^64 + 1, a factor of it
+    cout << (a.gcd(b * 7) == b && (b + 2).mod_inverse(a) * (b + 2) % a == 1) << " ";
+    cout << endl;
+
     cout << endl;
 
     cout << "Comparisans:     ";  // should be:  1 1 0 0 1 1 1 1 1 0 0 0 0 0
@@ -0,0 +1,7 @@
+// a second translation unit for test_bigint: every header is included here as well, so a definition in a header
+// that isn't inline (or a template) shows up as a duplicate symbol when the two are linked
+#include "BigInt.h"
+#include "FixedInt.h"
+#include "BigIntBatch.h"
+#include "ProductTree.h"
+#include "BigIntIO.h"